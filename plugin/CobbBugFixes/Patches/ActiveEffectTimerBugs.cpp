@@ -3,7 +3,10 @@
 #include "ReverseEngineered/Objects/ActiveEffect.h"
 #include "ReverseEngineered/Systems/012E32E8.h"
 #include "ReverseEngineered/GameSettings.h"
+#include "Services/Diagnostics.h"
 #include "Services/INI.h"
+#include "ActiveEffectTimerMath.h"
+#include <mutex>
 
 #define COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG 0
 
@@ -73,6 +76,19 @@ namespace CobbBugFixes {
          // that to compute a delta which is passed downstream, eventually making its way to 
          // ActiveEffect::AdvanceTime. We have found and hooked the function that updates the 
          // global actor timer, so that our own timer matches it perfectly.
+         //
+         // The rollover timer described above is now only a fallback. Effects past the unsafe 
+         // threshold normally use a "shadow clock:" we track their elapsed time ourselves as 
+         // a 64-bit fixed-point value in a side table, advance that by the exact frame time, 
+         // and write the nearest float back to the effect. This keeps durations exact no matter 
+         // how long an effect has run, and lets condition checks keep the vanilla staggering. 
+         // We only fall back to the rollover timer if the side table fills up.
+         //
+         // When we do fall back, we don't want every long-running effect to re-run its conditions 
+         // on the same frame: that's the very hitch that the vanilla staggering avoids. For these 
+         // effects, we give each one a phase offset within the update interval (derived from its 
+         // address) and check it against a global clock that never rolls over, so their updates 
+         // are spread evenly across the interval.
          // 
          // ---------------------------------------------------------------------------------------
          //
@@ -89,13 +105,65 @@ namespace CobbBugFixes {
          //    there's no way to tell them about it when they're loaded later.
          //
 
-         static float s_timer = 0.0;
-         static float s_safetyThreshold = 131072.0F; // number of seconds at which we can no longer reliably add 120FPS frame time
+         static Math::RolloverTimer s_timer;
 
          inline float _getInterval() {
             return RE::GMST::fActiveEffectConditionUpdateInterval->data.f32;
          }
 
+         namespace ShadowClock {
+            //
+            // Effects past the safety threshold have their elapsed time tracked here; see 
+            // Math::ShadowTable. Only those effects are stored, so the table stays small and 
+            // the vanilla path never touches it.
+            //
+            // We don't hook ActiveEffect destruction. Instead, the table notices when an effect's 
+            // timer no longer matches what we last wrote (because the timer was reset or the 
+            // address was reused), and entries that stop being touched are evicted once the 
+            // table starts to fill up.
+            //
+            static Math::ShadowTable<RE::ActiveEffect*> s_table;
+            static std::mutex s_lock;
+
+            void Tick() {
+               std::lock_guard<std::mutex> guard(s_lock);
+               s_table.Tick();
+            }
+            bool Advance(RE::ActiveEffect* effect, float delta) { // returns false if the table is full
+               std::lock_guard<std::mutex> guard(s_lock);
+               return s_table.Advance(effect, effect->elapsed, delta);
+            }
+            bool Get(RE::ActiveEffect* effect, Math::fixed_t& out) { // returns false if the table is full
+               std::lock_guard<std::mutex> guard(s_lock);
+               return s_table.Get(effect, effect->elapsed, out);
+            }
+         }
+         namespace Scheduler {
+            static double s_clock = 0.0; // advanced by ManageTimer; unlike s_timer, this never rolls over
+
+            bool IsDue(RE::ActiveEffect* effect, double delta, double interval) {
+               return Math::PhasedConditionDue(s_clock, Math::Phase(effect), delta, interval);
+            }
+         }
+         namespace Stats {
+            //
+            // Condition updates per frame, so that we can confirm that updates are staggered. 
+            // AdvanceTime can run on more than one thread, so the per-frame count is atomic.
+            //
+            static Diagnostics::Counter s_thisFrame;
+            static Diagnostics::FrameSeries<UInt32> s_series; // only touched by ManageTimer
+            static Diagnostics::ReportGate s_gate(60 * 1000);
+
+            void EndFrame() {
+               s_series.Add(s_thisFrame.Take());
+               if (!s_gate.Due())
+                  return;
+               if (INI::ActiveEffectTimerFixes::LogConditionUpdateStats.bCurrent)
+                  _MESSAGE("Active effect condition updates over the last %u frames: %.2f per frame on average; %u at peak.", s_series.frames, s_series.Average(), s_series.peak);
+               s_series.Reset();
+            }
+         }
+
          namespace ManageTimer {
             void _stdcall Inner(float set_to) {
                const float& existing = *RE::g_globalActorTimer;
@@ -103,22 +171,19 @@ namespace CobbBugFixes {
                if (delta == 0.0F)
                   return;
                if (delta < 0.0F) {
-                  s_timer = 0.0F;
+                  s_timer.Reset();
                   return;
                }
-               if (s_timer > _getInterval()) {
-                  //
-                  // We run this check before incrementing the timer; that way, we're pretty much guaranteed to 
-                  // increase the timer past the interval for one frame, before resetting it on the next. That's 
-                  // what we want; it's what we need in order for the other patches (which read the timer) to be 
-                  // aware of when the interval's been reached.
-                  //
-                  #if COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG == 1
-                     _MESSAGE("[%012d] Timer rollover from %f. Delta to be added is %f.", GetTickCount(), s_timer, delta);
-                  #endif
-                  s_timer = 0.0F;
-               }
-               s_timer += delta;
+               ShadowClock::Tick();
+               Scheduler::s_clock += delta;
+               Stats::EndFrame();
+               #if COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG == 1
+                  float before = s_timer.value;
+                  if (s_timer.Advance(delta, _getInterval()))
+                     _MESSAGE("[%012d] Timer rollover from %f. Delta to be added is %f.", GetTickCount(), before, delta);
+               #else
+                  s_timer.Advance(delta, _getInterval());
+               #endif
             }
             __declspec(naked) void Outer() {
                _asm {
@@ -141,7 +206,7 @@ namespace CobbBugFixes {
          namespace ActiveEffectAdvanceTime {
             void _stdcall Inner(float timeDelta, RE::ActiveEffect* effect, RE::Actor* target) {
                #if COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG != 1
-                  if (effect->elapsed < s_safetyThreshold) {
+                  if (effect->elapsed < Math::ce_safetyThreshold) {
                      effect->elapsed += timeDelta; // vanilla behavior
                      return;
                   }
@@ -149,8 +214,13 @@ namespace CobbBugFixes {
                //
                // Code below runs if the elapsed time is now too high to track accurately.
                //
-               if (s_timer >= _getInterval())
-                  effect->elapsed += s_timer;
+               if (ShadowClock::Advance(effect, timeDelta))
+                  return;
+               //
+               // The shadow clock is full, so fall back to the rollover timer.
+               //
+               if (s_timer.value >= _getInterval())
+                  effect->elapsed += s_timer.value;
                   //
                   // NOTE: This will break somewhat if Actor::AdvanceTime ever gets called multiple 
                   // times in a single frame, though from what I've seen that shouldn't happen unless 
@@ -188,12 +258,12 @@ namespace CobbBugFixes {
             // NOTE: ActiveEffect::AdvanceTime calls ActiveEffect::Unk_05 (which eventually calls 
             // ActiveEffect::DoConditionUpdate) before it advances the elapsed time.
             //
-            bool _stdcall Inner(RE::ActiveEffect* effect, float delta) { // returns true if we need to re-run conditions
+            bool _shouldUpdate(RE::ActiveEffect* effect, float delta) {
                double elapsed = effect->elapsed;
                double setting = RE::GMST::fActiveEffectConditionUpdateInterval->data.f32;
                #if COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG != 1
-                  if (elapsed < s_safetyThreshold)
-                     return (UInt32)(elapsed / setting) != (UInt32)((elapsed + delta) / setting);
+                  if (elapsed < Math::ce_safetyThreshold)
+                     return Math::VanillaConditionDue(elapsed, delta, setting);
                #endif
                //
                // Code below runs if the elapsed time is now too high to track accurately.
@@ -201,7 +271,7 @@ namespace CobbBugFixes {
                #if COBB_ACTIVE_EFFECT_TIMER_FIX_DEBUG
                   auto actor = effect->actorTarget->GetTargetActor();
                   if (actor && actor == *g_thePlayer) {
-                     if (s_timer > setting) {
+                     if (s_timer.Due(setting)) {
                         const char* name = "<unknown>";
                         {
                            auto ei = effect->effect;
@@ -214,13 +284,24 @@ namespace CobbBugFixes {
                               }
                            }
                         }
-                        _MESSAGE("[%012d] [AE:%08X:%s] Delta %f. Player will recheck conditions at timer %f / interval %f.", GetTickCount(), effect, name, delta, s_timer, setting);
+                        _MESSAGE("[%012d] [AE:%08X:%s] Delta %f. Player will recheck conditions at timer %f / interval %f.", GetTickCount(), effect, name, delta, s_timer.value, setting);
                         return true;
                      }
                      return false;
                   }
                #endif
-               return (s_timer > setting);
+               {
+                  Math::fixed_t current;
+                  if (ShadowClock::Get(effect, current))
+                     return Math::FixedConditionDue(current, delta, setting);
+               }
+               return Scheduler::IsDue(effect, delta, setting); // fallback if the shadow clock is full
+            }
+            bool _stdcall Inner(RE::ActiveEffect* effect, float delta) { // returns true if we need to re-run conditions
+               bool result = _shouldUpdate(effect, delta);
+               if (result)
+                  ++Stats::s_thisFrame;
+               return result;
             }
             __declspec(naked) void Outer() {
                //
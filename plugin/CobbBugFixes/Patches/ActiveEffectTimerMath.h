@@ -0,0 +1,218 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+//
+// The arithmetic behind the Active Effect Timer Bugfix, kept free of any dependency on the
+// game or on SKSE so that it can be reasoned about (and compiled) on its own. The patch in
+// ActiveEffectTimerBugs.cpp is responsible for reading values out of the game, locking,
+// and writing results back; everything here operates on plain numbers. See the comments
+// at the top of that file for the bugs themselves.
+//
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace ActiveEffectTimerBugs {
+         namespace Math {
+            constexpr float ce_safetyThreshold = 131072.0F; // number of seconds at which we can no longer reliably add 120FPS frame time
+
+            //
+            // Elapsed times in 32.32 fixed-point seconds. This is exact for frame deltas down to
+            // a quarter of a nanosecond and doesn't run out of range for about 136 years.
+            //
+            typedef uint64_t fixed_t;
+            constexpr double ce_fixedOne = 4294967296.0; // 1 << 32
+
+            inline fixed_t ToFixed(double seconds) {
+               return seconds > 0.0 ? (fixed_t)(seconds * ce_fixedOne) : 0;
+            }
+            inline double ToSeconds(fixed_t f) {
+               return (double)f / ce_fixedOne;
+            }
+
+            //
+            // Condition update checks. All of them return true if an effect with the given elapsed
+            // time should re-run its conditions before (delta) seconds are added to that time.
+            //
+            inline bool VanillaConditionDue(double elapsed, double delta, double interval) { // the game's own check
+               return (uint32_t)(elapsed / interval) != (uint32_t)((elapsed + delta) / interval);
+            }
+            inline bool FixedConditionDue(fixed_t elapsed, double delta, double interval) { // the game's check, done without precision loss
+               fixed_t i = ToFixed(interval);
+               if (!i)
+                  return true;
+               return (elapsed / i) != ((elapsed + ToFixed(delta)) / i);
+            }
+            //
+            // For effects we can't track exactly: each effect gets a phase offset in the range
+            // [0, 1) derived from its address, and is due when a global clock, shifted by that
+            // fraction of the interval, crosses a multiple of the interval.
+            //
+            // The global clock is advanced once per frame, before any effect is checked, so
+            // (clock) already includes this frame's (delta). We test the window that the clock
+            // just moved through, (clock - delta, clock], rather than predicting the next one:
+            // those windows tile the timeline exactly, so no crossing is missed or counted twice
+            // even when frame times vary.
+            //
+            inline double Phase(const void* key) {
+               return (double)((uint32_t)((uintptr_t)key >> 3) * 0x9E3779B1u) / 4294967296.0;
+            }
+            inline bool PhasedConditionDue(double clock, double phase, double delta, double interval) {
+               if (interval <= 0.0)
+                  return true;
+               double position = std::fmod(clock + phase * interval, interval);
+               return position < delta;
+            }
+
+            //
+            // The original rollover timer: it's synchronized to the global actor timer and rolls
+            // over to zero on the frame after it passes the condition update interval. We check
+            // before adding the delta, so the timer spends exactly one frame past the interval;
+            // that's what lets readers notice that the interval has been reached.
+            //
+            struct RolloverTimer {
+               float value = 0.0F;
+               //
+               void Reset() { this->value = 0.0F; }
+               bool Due(float interval) const { return this->value > interval; }
+               bool Advance(float delta, float interval) { // returns true if the timer rolled over
+                  bool rolled = this->Due(interval);
+                  if (rolled)
+                     this->value = 0.0F;
+                  this->value += delta;
+                  return rolled;
+               }
+            };
+
+            //
+            // Open-addressed (linear probing) hash table mapping effects to their elapsed time
+            // as a fixed_t. Keys are opaque pointers and are never dereferenced. Callers pass in
+            // the effect's own (float) elapsed time, which we use to detect resets: each slot
+            // remembers the float that we last read or wrote, and if the effect's current value
+            // doesn't match, then either the effect's timer was reset or the key now refers to a
+            // different object; either way, we reseed the slot from the float.
+            //
+            // Slots that haven't been touched in (staleFrames) calls to Tick() are evicted when
+            // the table starts to fill up. A sweep visits every slot, so we run at most one per
+            // Tick(); if the table is still full after that, further misses in the same frame
+            // fail immediately instead of sweeping again. The table does no locking of its own.
+            //
+            template<typename Key, uint32_t capacityLog = 12> class ShadowTable {
+               public:
+                  static constexpr uint32_t capacity    = 1 << capacityLog;
+                  static constexpr uint32_t sweepAt     = capacity * 3 / 4;
+                  static constexpr uint32_t staleFrames = 600; // about ten seconds at 60FPS
+                  //
+               private:
+                  struct Slot {
+                     Key      key         = nullptr;
+                     float    lastWritten = 0.0F;
+                     uint32_t lastTouched = 0;
+                     fixed_t  elapsed     = 0;
+                  };
+                  Slot     slots[capacity];
+                  uint32_t count = 0;
+                  uint32_t frame = 0;
+                  uint32_t lastSweep = UINT32_MAX; // value of (frame) at the last sweep
+                  //
+                  static uint32_t _hash(Key key) {
+                     return ((uint32_t)((uintptr_t)key >> 3) * 0x9E3779B1u) >> (32 - capacityLog); // Fibonacci hashing
+                  }
+                  void _erase(uint32_t i) { // backward-shift deletion, so we never need tombstones
+                     constexpr uint32_t mask = capacity - 1;
+                     uint32_t j = i;
+                     while (true) {
+                        j = (j + 1) & mask;
+                        auto& next = this->slots[j];
+                        if (!next.key)
+                           break;
+                        //
+                        // An entry can move back into the hole only if its home slot doesn't lie
+                        // cyclically within (i, j].
+                        //
+                        uint32_t home = _hash(next.key);
+                        bool     stay = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+                        if (!stay) {
+                           this->slots[i] = next;
+                           i = j;
+                        }
+                     }
+                     this->slots[i] = Slot();
+                     --this->count;
+                  }
+                  void _sweep() {
+                     for (uint32_t i = 0; i < capacity; ) {
+                        auto& slot = this->slots[i];
+                        if (slot.key && this->frame - slot.lastTouched > staleFrames) {
+                           this->_erase(i); // may shift a later entry into slot i, so check it again
+                           continue;
+                        }
+                        ++i;
+                     }
+                  }
+                  Slot* _get(Key key, float elapsed) { // returns nullptr if the table is full
+                     constexpr uint32_t mask = capacity - 1;
+                     uint32_t i = _hash(key);
+                     while (auto current = this->slots[i].key) {
+                        if (current == key) {
+                           auto& slot = this->slots[i];
+                           if (slot.lastWritten != elapsed) {
+                              slot.elapsed     = ToFixed(elapsed);
+                              slot.lastWritten = elapsed;
+                           }
+                           slot.lastTouched = this->frame;
+                           return &slot;
+                        }
+                        i = (i + 1) & mask;
+                     }
+                     if (this->count >= sweepAt) {
+                        if (this->lastSweep == this->frame)
+                           return nullptr;
+                        this->lastSweep = this->frame;
+                        this->_sweep();
+                        if (this->count >= sweepAt)
+                           return nullptr;
+                        //
+                        // The key still isn't present (sweeping only removes entries), but the 
+                        // sweep may have shifted entries around, so find the new insertion point.
+                        //
+                        i = _hash(key);
+                        while (this->slots[i].key)
+                           i = (i + 1) & mask;
+                     }
+                     auto& slot = this->slots[i];
+                     slot.key         = key;
+                     slot.elapsed     = ToFixed(elapsed);
+                     slot.lastWritten = elapsed;
+                     slot.lastTouched = this->frame;
+                     ++this->count;
+                     return &slot;
+                  }
+                  //
+               public:
+                  void     Tick() { ++this->frame; }
+                  uint32_t size() const { return this->count; }
+                  //
+                  // Adds (delta) to the effect's elapsed time and writes the nearest float back
+                  // to (elapsed). Returns false, leaving (elapsed) alone, if the table is full.
+                  //
+                  bool Advance(Key key, float& elapsed, float delta) {
+                     auto slot = this->_get(key, elapsed);
+                     if (!slot)
+                        return false;
+                     slot->elapsed += ToFixed(delta);
+                     elapsed = (float)ToSeconds(slot->elapsed);
+                     slot->lastWritten = elapsed;
+                     return true;
+                  }
+                  bool Get(Key key, float elapsed, fixed_t& out) { // returns false if the table is full
+                     auto slot = this->_get(key, elapsed);
+                     if (!slot)
+                        return false;
+                     out = slot->elapsed;
+                     return true;
+                  }
+            };
+         }
+      }
+   }
+}
@@ -3,6 +3,10 @@
 #include "ReverseEngineered/Forms/Projectile.h"
 #include "skse/SafeWrite.h"
 
+#include "Services/Diagnostics.h"
+#include "Services/INI.h"
+#include <atomic>
+
 namespace CobbBugFixes {
    namespace Patches {
       namespace ArcheryDownwardArrowFix {
@@ -56,7 +60,18 @@ namespace CobbBugFixes {
          // raycast more accurately reflects what you should and shouldn't be able 
          // to shoot at.
          //
+         // We compute the origin height directly each time rather than caching it per actor. 
+         // RaycastTiming (below) times this computation next to the raycast it feeds, so that 
+         // whether a cache would be worth it can be judged from the log in a real battle.
+         //
+         namespace RaycastTiming {
+            extern bool enabled;
+            void _stdcall OriginTime(UInt64 ticks);
+         }
          void _stdcall Inner(NiPoint3& out, RE::Actor* shooter, RE::Projectile* projectile) {
+            LARGE_INTEGER start;
+            if (RaycastTiming::enabled)
+               QueryPerformanceCounter(&start);
             out = shooter->pos;
             float height = CALL_MEMBER_FN(shooter, GetComputedHeight)();
             if (height > 0.0F) {
@@ -67,6 +82,11 @@ namespace CobbBugFixes {
                height = 96.0F; // a "default" height used by TESObjectWEAP::Fire
             }
             out.z += height;
+            if (RaycastTiming::enabled) {
+               LARGE_INTEGER end;
+               QueryPerformanceCounter(&end);
+               RaycastTiming::OriginTime((UInt64)(end.QuadPart - start.QuadPart));
+            }
          }
          __declspec(naked) void Outer() {
             _asm {
@@ -79,7 +99,100 @@ namespace CobbBugFixes {
                jmp  eax;
             }
          }
+         namespace RaycastTiming {
+            //
+            // Optional instrumentation (enabled along with LogRaycastStats): times the raycast 
+            // itself and the computation of its origin, and reports raycasts per second, and 
+            // raycasts, raycast time, and origin time per frame. Only frames with at least one 
+            // raycast are counted.
+            //
+            bool enabled = false;
+            static Diagnostics::Counter s_frameCount;
+            static std::atomic<UInt64>  s_frameTicks(0);
+            static std::atomic<UInt64>  s_originTicks(0);
+            static Diagnostics::FrameDetector s_frame;
+            static Diagnostics::ReportGate    s_gate(10 * 1000);
+            static thread_local LARGE_INTEGER s_start;
+            //
+            struct Summary {
+               Diagnostics::FrameSeries<UInt32> raycasts;
+               Diagnostics::FrameSeries<UInt64> ticks;
+               Diagnostics::FrameSeries<UInt64> origin;
+            };
+            static Summary s_summary; // only touched by the thread that closes out a frame
+
+            void _closeFrame() {
+               UInt32 count = s_frameCount.Take();
+               UInt64 ticks  = s_frameTicks.exchange(0);
+               UInt64 origin = s_originTicks.exchange(0);
+               auto&  s = s_summary;
+               if (count) {
+                  s.raycasts.Add(count);
+                  s.ticks.Add(ticks);
+                  s.origin.Add(origin);
+               }
+               DWORD elapsed;
+               if (!s_gate.Due(&elapsed))
+                  return;
+               if (s.raycasts.frames) {
+                  LARGE_INTEGER frequency;
+                  QueryPerformanceFrequency(&frequency);
+                  double toMicroseconds = 1000000.0 / frequency.QuadPart;
+                  _MESSAGE("Archery raycasts over %u frames with raycasts: %.1f per second; %.1f per frame (peak %u); %.1f microseconds per frame (peak %.1f) in the raycast, and %.1f (peak %.1f) computing its origin.",
+                     s.raycasts.frames,
+                     elapsed ? s.raycasts.total * 1000.0 / elapsed : 0.0,
+                     s.raycasts.Average(), s.raycasts.peak,
+                     s.ticks.Average() * toMicroseconds, s.ticks.peak * toMicroseconds,
+                     s.origin.Average() * toMicroseconds, s.origin.peak * toMicroseconds
+                  );
+               }
+               s = Summary();
+            }
+            void _stdcall OriginTime(UInt64 ticks) { // the origin is computed just before the raycast, so it may be the first thing in a frame
+               if (s_frame.NewFrame())
+                  _closeFrame();
+               s_originTicks += ticks;
+            }
+            void _stdcall Begin() {
+               if (s_frame.NewFrame())
+                  _closeFrame();
+               QueryPerformanceCounter(&s_start);
+            }
+            void _stdcall End() {
+               LARGE_INTEGER end;
+               QueryPerformanceCounter(&end);
+               ++s_frameCount;
+               s_frameTicks += (UInt64)(end.QuadPart - s_start.QuadPart);
+            }
+            __declspec(naked) void Outer() {
+               //
+               // Replaces the call to the raycast, which is a member function (ecx) taking two 
+               // arguments that it pops itself.
+               //
+               _asm {
+                  push ecx; // protect
+                  call Begin; // stdcall
+                  pop  ecx; // restore
+                  push dword ptr [esp + 0x8]; // Arg2
+                  push dword ptr [esp + 0x8]; // Arg1 (offset shifted by the previous push)
+                  mov  eax, 0x007A0090;
+                  call eax;
+                  push eax; // protect return value
+                  push edx; // protect return value
+                  call End; // stdcall
+                  pop  edx; // restore
+                  pop  eax; // restore
+                  retn 8;
+               }
+            }
+            void Apply() {
+               enabled = true;
+               WriteRelCall(0x0079B1A6, (UInt32)&Outer);
+            }
+         }
          void Apply() {
+            if (INI::ArcheryDownwardArrowFix::LogRaycastStats.bCurrent)
+               RaycastTiming::Apply();
             //
             // You can get to the function we're patching by digging down from ArrowProjectile::Unk_AB. Look 
             // for code that calls a TESObjectREFR method that returns true if the actor has an ExtraAction. 
@@ -1,10 +1,14 @@
 #include "CrashFixes.h"
 #include "skse/SafeWrite.h"
+#include "DetectShutdown.h"
 #include "../Services/INI.h"
 
 namespace CobbBugFixes {
    namespace Patches {
       namespace CrashFixes {
+         volatile UInt32 hits_singleton012E2CF8     = 0;
+         volatile UInt32 hits_tesIdleFormDestructor = 0;
+         //
          namespace Singleton012E2CF8_Unk68_Subroutine006483F0 {
             //
             // Sometimes, this singleton can be deleted, but the following call still 
@@ -22,6 +26,9 @@ namespace CobbBugFixes {
                   mov  edx, 0x0064840D;
                   jmp  edx;
                lReturn:
+                  pushfd;
+                  lock inc dword ptr [hits_singleton012E2CF8];
+                  popfd;
                   mov  edx, 0x0064847B;
                   jmp  edx;
                }
@@ -40,14 +47,39 @@ namespace CobbBugFixes {
             // It is currently not known what the array items are, or what the significance is 
             // of nullptr entries appearing when Bethesda didn't bother checking for them.
             //
+            // We also use this hook to tell DetectShutdown when the game has started tearing 
+            // down forms. DetectShutdown's own hook arms us once the game's main loop has 
+            // exited, so the first idle form destroyed after that is part of the teardown, 
+            // however idle forms may be destroyed earlier in the session. Until we're armed, 
+            // and again once we've reported, the only extra cost per array entry is a single 
+            // compare. If this guard is disabled, DetectShutdown has no way to see the 
+            // teardown begin.
+            //
+            static bool s_watchTeardown = false;
+            //
+            void _stdcall ReportTeardown() {
+               s_watchTeardown = false;
+               DetectShutdown::Phases::Mark(DetectShutdown::Phases::form_teardown);
+            }
             __declspec(naked) void Outer() {
                _asm {
+                  cmp  byte ptr [s_watchTeardown], 0;
+                  je   lGuard;
+                  pushad;
+                  pushfd;
+                  call ReportTeardown; // stdcall
+                  popfd;
+                  popad;
+               lGuard:
                   test eax, eax;
                   jz   lContinue;
                   mov  dword ptr [eax+0x24], 0; // reproduce patched-over instruction
                   mov  ecx, 0x0055E066; // TESIdleForm::~TESIdleForm+0xE6
                   jmp  ecx;
                lContinue:
+                  pushfd;
+                  lock inc dword ptr [hits_tesIdleFormDestructor];
+                  popfd;
                   mov  ecx, 0x0055E070; // TESIdleForm::~TESIdleForm+0xF0
                   jmp  ecx;
                }
@@ -59,6 +91,10 @@ namespace CobbBugFixes {
             }
          }
          //
+         void OnShutdown() {
+            if (INI::CrashFixes::TESIdleFormDestructor.bCurrent)
+               TESIdleFormDestructor::s_watchTeardown = true;
+         }
          void Apply() {
             Singleton012E2CF8_Unk68_Subroutine006483F0::Apply();
             TESIdleFormDestructor::Apply();
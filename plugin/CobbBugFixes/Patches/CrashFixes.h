@@ -3,6 +3,14 @@
 namespace CobbBugFixes {
    namespace Patches {
       namespace CrashFixes {
+         //
+         // Incremented whenever a guard catches a bad pointer. DetectShutdown reads these for 
+         // its shutdown report.
+         //
+         extern volatile UInt32 hits_singleton012E2CF8;
+         extern volatile UInt32 hits_tesIdleFormDestructor;
+         //
+         void OnShutdown(); // called from DetectShutdown's hook; watches for the game to start tearing down forms
          void Apply();
       }
    }
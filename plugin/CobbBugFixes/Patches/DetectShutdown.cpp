@@ -1,5 +1,13 @@
 #include "DetectShutdown.h"
+#include "CrashFixes.h"
 #include "skse/SafeWrite.h"
+#include <cstdarg>
+#include <cstdio>
+#include <shlobj.h> // SHGetFolderPath
+#include <string>
+
+#include "Services/INI.h"
+#include "Services/PlayerAIDriven.h"
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -9,14 +17,130 @@ namespace CobbBugFixes {
          // This is used by the crash logger, so that it can tell that a crash has occurred 
          // after the game has mostly shut down.
          //
+         // If the user opts into it, we also use this point to end the process outright. The 
+         // rest of the game's teardown can take several seconds on large load orders, most of 
+         // it spent walking and freeing structures (e.g. TESIdleForm::unk20) whose memory the 
+         // OS is about to reclaim anyway, and it's where the shutdown-only crashes that 
+         // CrashFixes guards against happen. By this point, there's nothing left to save: 
+         // SKSE writes co-saves synchronously while the game saves, so none are pending, and 
+         // our own log only needs its CRT buffers flushed. The trade-off is that other DLLs 
+         // won't get DLL_PROCESS_DETACH notifications, so anything they've buffered without 
+         // flushing is lost; that's why this is opt-in.
+         //
          using handler_t = void(*)();
          static handler_t prior = nullptr;
 
+         namespace Phases {
+            //
+            // From inside our DLL, the last thing we can observe is our own DLL_PROCESS_DETACH, 
+            // which ExitProcess delivers after the game's main() has returned and its static 
+            // destructors have run. That's as close to "process exit" as we can measure, so the 
+            // DLL detach and process exit phases are one and the same here.
+            //
+            // That also means the report is usually written from DllMain, under the loader 
+            // lock, where calling into the log (and so into the CRT's stream locks, which 
+            // another thread may be holding) can deadlock. Instead, we open a separate file 
+            // while we're still on the game's main thread, format the report into a static 
+            // buffer, and hand that straight to WriteFile.
+            //
+            static LARGE_INTEGER s_times[count] = {};
+            static UInt32 s_guardHitsAtExit[2] = {};
+            static bool   s_reported = false;
+            static HANDLE s_file     = INVALID_HANDLE_VALUE;
+            static char   s_text[2048];
+            static UInt32 s_length   = 0;
+            //
+            const char* _name(UInt32 p) {
+               switch (p) {
+                  case main_loop_exit: return "Main loop exit";
+                  case form_teardown:  return "Form teardown begins";
+                  case process_exit:   return "Process exit";
+               }
+               return "?";
+            }
+            void Open() {
+               char path[MAX_PATH];
+               if (FAILED(SHGetFolderPath(NULL, CSIDL_MYDOCUMENTS | CSIDL_FLAG_CREATE, NULL, SHGFP_TYPE_CURRENT, path))) {
+                  _MESSAGE("Unable to locate the My Documents folder; shutdown timing won't be reported.");
+                  return;
+               }
+               std::string file = path;
+               file += "\\My Games\\Skyrim\\SKSE\\CobbBugFixes-Shutdown.log";
+               s_file = CreateFileA(file.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+               if (s_file == INVALID_HANDLE_VALUE)
+                  _MESSAGE("Unable to create %s (error %u); shutdown timing won't be reported.", file.c_str(), GetLastError());
+               else
+                  _MESSAGE("Shutdown timing will be written to %s.", file.c_str());
+            }
+            void _append(const char* format, ...) { // no locks taken; safe under the loader lock
+               if (s_length >= sizeof(s_text))
+                  return;
+               va_list args;
+               va_start(args, format);
+               int written = _vsnprintf(s_text + s_length, sizeof(s_text) - s_length, format, args);
+               va_end(args);
+               s_length = written < 0 ? sizeof(s_text) : s_length + written;
+            }
+            void Mark(Phase p) {
+               if (s_times[p].QuadPart)
+                  return;
+               QueryPerformanceCounter(&s_times[p]);
+               if (p == main_loop_exit) {
+                  s_guardHitsAtExit[0] = CrashFixes::hits_singleton012E2CF8;
+                  s_guardHitsAtExit[1] = CrashFixes::hits_tesIdleFormDestructor;
+               }
+            }
+            void Report(const char* how) {
+               if (s_reported || !s_times[main_loop_exit].QuadPart || s_file == INVALID_HANDLE_VALUE)
+                  return;
+               s_reported = true;
+               Mark(process_exit);
+               LARGE_INTEGER frequency;
+               QueryPerformanceFrequency(&frequency);
+               auto start = s_times[main_loop_exit].QuadPart;
+               //
+               _append("Shutdown timing (%s):\r\n", how);
+               for (UInt32 i = 0; i < count; ++i) {
+                  if (!s_times[i].QuadPart) {
+                     if (i == form_teardown && !INI::CrashFixes::TESIdleFormDestructor.bCurrent) // the TESIdleForm hook is what observes it
+                        _append(" - %s: unobservable (CrashFixes:TESIdleFormDestructor is disabled)\r\n", _name(i));
+                     else
+                        _append(" - %s: not observed\r\n", _name(i));
+                     continue;
+                  }
+                  double ms = (double)(s_times[i].QuadPart - start) * 1000.0 / (double)frequency.QuadPart;
+                  _append(" - %s: +%.1f ms\r\n", _name(i), ms);
+               }
+               _append(" - Crash guards fired during shutdown: Singleton012E2CF8_Unk68_Subroutine006483F0 %u time(s); TESIdleFormDestructor %u time(s).\r\n",
+                  CrashFixes::hits_singleton012E2CF8 - s_guardHitsAtExit[0],
+                  CrashFixes::hits_tesIdleFormDestructor - s_guardHitsAtExit[1]
+               );
+               DWORD written;
+               WriteFile(s_file, s_text, s_length, &written, NULL);
+               CloseHandle(s_file);
+               s_file = INVALID_HANDLE_VALUE;
+            }
+         }
+
          void _stdcall Outer() {
             is_shutting_down = true;
+            Phases::Mark(Phases::main_loop_exit);
+            CrashFixes::OnShutdown();
             _MESSAGE("Detected that the game is shutting down...");
+            Phases::Open();
             if (prior)
                (prior)();
+            PlayerAIDriven::Stop();
+            if (INI::CrashFixes::FastExit.bCurrent) {
+               _MESSAGE("Fast exit is enabled; terminating the process now instead of running the game's teardown.");
+               Phases::Report("fast exit");
+               fflush(nullptr); // all CRT streams, including our log
+               TerminateProcess(GetCurrentProcess(), 0);
+            }
+         }
+         void OnDllDetach(bool processExiting) {
+            if (processExiting)
+               Phases::Report("normal exit");
          }
          void Apply() {
             constexpr uint32_t address = 0x0069E864; // address of a CALL to a no-op function, near the end of the game's main()
@@ -5,6 +5,21 @@ namespace CobbBugFixes {
       namespace DetectShutdown {
          extern bool is_shutting_down;
          //
+         // Shutdown timing. Each phase is timestamped the first time it's reached, and a 
+         // summary is written to CobbBugFixes-Shutdown.log, next to our log, when the process 
+         // exits.
+         //
+         namespace Phases {
+            enum Phase {
+               main_loop_exit, // the game's main() has left its loop
+               form_teardown,  // the game has started destroying forms; only observable when CrashFixes:TESIdleFormDestructor is enabled
+               process_exit,   // ExitProcess is detaching DLLs, or we're about to terminate the process ourselves
+               count,
+            };
+            void Mark(Phase);
+         }
+         void OnDllDetach(bool processExiting); // called from DllMain
+         //
          void Apply();
       }
    }
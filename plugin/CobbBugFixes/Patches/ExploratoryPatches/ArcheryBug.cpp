@@ -3,6 +3,7 @@
 #include "ReverseEngineered/Forms/Projectile.h"
 #include "ReverseEngineered/NetImmerse/nodes.h"
 #include "ReverseEngineered/NetImmerse/types.h"
+#include "Services/Trace.h"
 #include "skse/SafeWrite.h"
 
 //
@@ -10,6 +11,11 @@
 // player to spawn at their feet, when shooting in third-person while 
 // perched on a downward slope and aiming at a downward angle.
 //
+// The logging hooks write to the binary trace (see Services/Trace.h) 
+// rather than to the log, since they run for every shot fired by any 
+// actor. Node names aren't recorded; match the node pointer against 
+// a one-off _MESSAGE if you need them.
+//
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -17,24 +23,25 @@ namespace CobbBugFixes {
          namespace ArcheryBug {
             namespace LogActorShotNode {
                void _stdcall Inner(NiNode* node, RE::Actor* actor) {
-                  _MESSAGE("Actor [ACHR:%08X] (%08X) is firing a projectile from node %s (%08X).", actor->formID, actor, node->m_name, node);
-                  auto& p = actor->pos;
-                  _MESSAGE(" - Actor position: (%f, %f, %f)", p.x, p.y, p.z);
-                  p = node->m_worldTransform.pos;
-                  _MESSAGE(" - Node  position: (%f, %f, %f)", p.x, p.y, p.z);
+                  auto entry = Trace::Begin(Trace::Event::archery_shot_node);
+                  if (!entry)
+                     return;
+                  auto& data = entry->data;
+                  data.u[0] = actor->formID;
+                  data.u[1] = (UInt32)node;
+                  data.f[2] = actor->pos.x;
+                  data.f[3] = actor->pos.y;
+                  data.f[4] = actor->pos.z;
+                  data.f[5] = node->m_worldTransform.pos.x;
+                  data.f[6] = node->m_worldTransform.pos.y;
+                  data.f[7] = node->m_worldTransform.pos.z;
                   //
                   auto actorNode = actor->GetNiNode();
                   if (actorNode) {
-                     _MESSAGE(" - Actor node-70: %s", actorNode->m_name);
-                     p = actorNode->worldTransform.pos;
-                     _MESSAGE(" - Actor node-70 position: (%f, %f, %f)", p.x, p.y, p.z);
-                  }
-                  //
-                  actorNode = actor->Unk_8D();
-                  if (actorNode) {
-                     _MESSAGE(" - Actor node-8D: %s", actorNode->m_name);
-                     p = actorNode->worldTransform.pos;
-                     _MESSAGE(" - Actor node-8D position: (%f, %f, %f)", p.x, p.y, p.z);
+                     auto& p = actorNode->worldTransform.pos;
+                     data.f[8]  = p.x;
+                     data.f[9]  = p.y;
+                     data.f[10] = p.z;
                   }
                }
                __declspec(naked) void Outer() {
@@ -56,13 +63,16 @@ namespace CobbBugFixes {
             }
             namespace LogActorShotProjectile {
                void _stdcall Inner(RE::TESObjectREFR* projectile) {
-                  _MESSAGE("Fired projectile is [REFR:%08X] (%08X).", projectile->formID, projectile);
+                  auto entry = Trace::Begin(Trace::Event::archery_shot_projectile);
+                  if (!entry)
+                     return;
+                  auto& data = entry->data;
+                  data.u[0] = projectile->formID;
                   if (RE::TESForm* base = projectile->baseForm)
-                     _MESSAGE(" - Base form: [FORM:%08X] (%08X)", base->formID, base);
-                  auto& p = projectile->pos;
-                  _MESSAGE(" - Position: (%f, %f, %f)", p.x, p.y, p.z);
-                  //p = projectile->rot;
-                  //_MESSAGE(" - Rotation: (%f, %f, %f)", p.x, p.y, p.z);
+                     data.u[1] = base->formID;
+                  data.f[2] = projectile->pos.x;
+                  data.f[3] = projectile->pos.y;
+                  data.f[4] = projectile->pos.z;
                }
                __declspec(naked) void Outer() {
                   _asm {
@@ -77,59 +87,14 @@ namespace CobbBugFixes {
                   WriteRelJump(0x004AB35D, (UInt32)&Outer);
                }
             }
-            namespace MoveArrowInitialPositionForward {
-               //
-               // Hypothesis: arrows directly in front of your bow, but are positioned by their 
-               // tips, so it's possible for the back of the arrow to impact the ground beneath 
-               // you. Can we fix the bug by making them spawn further ahead?
-               //
-               constexpr float ce_forwardDistance = 58.0F; // arrows are typically 59 or 60 units long
-
-               void _stdcall Inner(NiNode* node, float* pitch, float* yaw, NiPoint3* position) {
-                  {  // Reproduce vanilla code
-                     //
-                     // The vanilla code writes overtop the arguments after pulling them into 
-                     // registers and passing them to another call. This prevents our hook from 
-                     // being able to catch the arguments. We need to replace the whole function.
-                     //
-                     struct Shim {
-                        DEFINE_MEMBER_FN_LONG(Shim, Subroutine00AAD320, void, 0x00AAD320, float*, float*, float*);
-                     };
-                     auto  p = (Shim*)&node->m_worldTransform;
-                     float f;
-                     CALL_MEMBER_FN(p, Subroutine00AAD320)(yaw, pitch, &f);
-                  }
-                  //
-                  // Pitch and yaw are in radians.
-                  //
-                  auto     matrix = RE::NiMatrix33::ConstructFromEuler(*pitch, 0, *yaw);
-                  NiPoint3 dir    = matrix.Forward();
-                  dir *= ce_forwardDistance;
-                  *position += dir;
-                  //
-                  // This has the desired effect -- making the arrow start 58 world units ahead 
-                  // of where it normally would -- but that doesn't prevent the arrow from colliding 
-                  // at the player's feet. Strange. I tried it with double the needed distance, even, 
-                  // and that still didn't prevent the collision.
-                  //
-                  // Well, being able to tamper with arrow trajectories is pretty useful. If we 
-                  // ever get raycasts working, we could even add something like aim assist, I 
-                  // suppose. For now, though, we need to search elsewhere to fix this bug.
-                  //
-                  // Debug logging indicates that the arrow DOES spawn at the place we're telling it 
-                  // to -- well ahead of the cliff we're standing on during the test. Something must 
-                  // either be moving it back under the player, or simulating a trajectory from the 
-                  // player to the initial position and "correcting" the arrow upon discovering that 
-                  // it "would have" hit -- and it must only be doing that for downward-aimed arrows.
-                  //
-                  _MESSAGE("Final arrow trajectory:");
-                  _MESSAGE(" - Fire from: (%f, %f, %f)", position->x, position->y, position->z);
-                  _MESSAGE(" - Pitch: %f; Yaw: %f.", *pitch, *yaw);
-               }
-               void Apply() {
-                  WriteRelJump(0x004D6750, (UInt32)&Inner); // TESObjectREFR::AdjustProjectileFireTrajectory + 0x00
-               }
-            }
+            //
+            // We tried moving arrows' initial positions forward (by replacing 
+            // TESObjectREFR::AdjustProjectileFireTrajectory), on the theory that the back of 
+            // the arrow was hitting the ground beneath the shooter. The arrow did spawn where 
+            // we told it to, but it still collided at the shooter's feet; the real cause is 
+            // the raycast described below. The trajectory hook itself turned out to be useful, 
+            // and now lives on as Patches/ProjectileTrajectory.
+            //
             //
             // Bethesda spawns the arrow at a point just in front of your bow. However, if you're 
             // aiming downward at the ground, this point will be below the ground. In order to 
@@ -186,7 +151,6 @@ namespace CobbBugFixes {
                LogActorShotNode::Apply();
                LogActorShotProjectile::Apply();
                //
-               //MoveArrowInitialPositionForward::Apply();
                //PreventWeirdHavokCall::Apply();
                AdjustWeirdHavokCall::Apply();
             }
@@ -1,22 +1,21 @@
 #include "ModelLoadingTest.h"
-#include "ReverseEngineered\Shared.h"
 #include "skse/NiNodes.h"
 #include "skse/NiTypes.h"
+#include "skse/Utilities.h" // GetRuntimeDirectory
+#include <fstream>
+#include <string>
+#include <vector>
+#include <psapi.h> // GetProcessMemoryInfo
+
+#include "Services/INI.h"
+#include "Services/ModelLoading.h"
 
 namespace CobbBugFixes {
    namespace Patches {
       namespace Exploratory {
          namespace ModelLoadingTest {
-            struct LoadModelOptions {
-               UInt32 unk00 = 3;
-               UInt32 unk04 = 3;
-               bool   unk08 = false;
-               bool   unk09 = false; // "is facegen head?" "is helmet?"
-               bool   unk0A = true;
-               bool   unk0B = true;
-            };
-            DEFINE_SUBROUTINE(UInt32, Subroutine00AF5820_MaybeLoadModel, 0x00AF5820, const char* path, NiPointer<NiNode>& out, LoadModelOptions& options);
-            // another subroutine with the same signature seems to be used for load screens: 0x00AF5680
+            using ModelLoading::LoadModel;
+            using ModelLoading::LoadModelOptions;
 
             constexpr char* ce_filePath = "Dungeons/Dwemer/Animated/DweButton/DweButton01.nif";
 
@@ -43,7 +42,7 @@ namespace CobbBugFixes {
                LoadModelOptions options;
                _MESSAGE("About to test loading a model...");
                _MESSAGE("Path: %s", ce_filePath);
-               auto eax = Subroutine00AF5820_MaybeLoadModel(ce_filePath, content, options);
+               auto eax = LoadModel(ce_filePath, content, options);
                if (eax == 0) {
                   _MESSAGE("Loading seems to have worked.");
                   if (content) {
@@ -71,6 +70,149 @@ namespace CobbBugFixes {
                }
                _MESSAGE("Test complete.");
             }
+
+            namespace Benchmark {
+               //
+               // The model loader goes through the game's model database, so a second load of 
+               // a model that's still referenced is just a cache lookup. We measure three cases: 
+               // the "cold" load is the first load of each model, which (if nothing else in the 
+               // game is using it) has to read and parse the file; "re-load" loads release the 
+               // model after each load, so they parse the file again, but the file's data is 
+               // now in the OS file cache and any BSA reads have already been done, so they're 
+               // not cold; and "warm" loads hold one reference for the duration, so every load 
+               // is a cache hit.
+               //
+               // The private bytes delta is only a rough guide. It's a process-wide counter, and 
+               // the game's other threads (audio, Havok, background loading, and so on) keep 
+               // allocating and freeing while we load, so for small models it's dominated by 
+               // their activity rather than ours. It's most meaningful for large models, and 
+               // when the benchmark runs with the game otherwise idle.
+               //
+               struct Sample {
+                  UInt32 result;
+                  double microseconds;
+                  UInt32 nodes;
+                  SInt64 privateBytes; // change in the process's private bytes across the load; includes other threads' allocations
+               };
+
+               UInt32 _countObjects(NiAVObject* object) {
+                  if (!object)
+                     return 0;
+                  UInt32 count  = 1;
+                  auto   casted = object->GetAsNiNode();
+                  if (casted)
+                     for (UInt32 i = 0; i < casted->m_children.m_emptyRunStart; i++)
+                        count += _countObjects(casted->m_children.m_data[i]);
+                  return count;
+               }
+               SInt64 _privateBytes() {
+                  PROCESS_MEMORY_COUNTERS_EX counters;
+                  counters.cb = sizeof(counters);
+                  if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+                     return 0;
+                  return counters.PrivateUsage;
+               }
+               Sample _load(const char* path, NiPointer<NiNode>& out, double ticksToMicroseconds) {
+                  Sample s;
+                  LARGE_INTEGER start;
+                  LARGE_INTEGER end;
+                  SInt64 before = _privateBytes();
+                  QueryPerformanceCounter(&start);
+                  s.result = LoadModel(path, out);
+                  QueryPerformanceCounter(&end);
+                  s.privateBytes = _privateBytes() - before;
+                  s.microseconds = (double)(end.QuadPart - start.QuadPart) * ticksToMicroseconds;
+                  s.nodes = _countObjects(out);
+                  return s;
+               }
+               void _readList(const std::string& path, std::vector<std::string>& out) {
+                  std::ifstream file(path);
+                  std::string   line;
+                  while (std::getline(file, line)) {
+                     size_t first = line.find_first_not_of(" \t\r");
+                     if (first == std::string::npos || line[first] == ';')
+                        continue;
+                     size_t last = line.find_last_not_of(" \t\r");
+                     out.push_back(line.substr(first, last - first + 1));
+                  }
+               }
+               void _write(std::ofstream& csv, const std::string& path, const char* pass, UInt32 iteration, const Sample& s) {
+                  char buffer[128];
+                  snprintf(buffer, sizeof(buffer), ",%s,%u,%08X,%.1f,%u,%lld\n", pass, iteration, s.result, s.microseconds, s.nodes, s.privateBytes);
+                  csv << '"';
+                  for (char c : path) {
+                     if (c == '"')
+                        csv << '"'; // CSV escapes a quote by doubling it
+                     csv << c;
+                  }
+                  csv << '"' << buffer;
+               }
+            }
+            void RunBenchmark() {
+               static bool s_ran = false;
+               if (s_ran || INI::ModelLoadBenchmark::Enabled.bCurrent == false)
+                  return;
+               s_ran = true;
+               //
+               std::string folder = GetRuntimeDirectory();
+               if (folder.empty())
+                  return;
+               folder += "Data\\SKSE\\Plugins\\";
+               std::vector<std::string> paths;
+               Benchmark::_readList(folder + "CobbBugFixes_ModelBenchmark.txt", paths);
+               if (paths.empty()) {
+                  _MESSAGE("Model load benchmark: no model paths were listed in CobbBugFixes_ModelBenchmark.txt. Skipping.");
+                  return;
+               }
+               std::ofstream csv(folder + "CobbBugFixes_ModelBenchmark.csv", std::ios::out | std::ios::trunc);
+               if (!csv) {
+                  _MESSAGE("Model load benchmark: unable to open CobbBugFixes_ModelBenchmark.csv for writing. Skipping.");
+                  return;
+               }
+               csv << "path,pass,iteration,result,microseconds,nodes,private_bytes_delta\n";
+               //
+               UInt32 iterations = INI::ModelLoadBenchmark::Iterations.uCurrent;
+               if (!iterations)
+                  iterations = 1;
+               double ticksToMicroseconds;
+               {
+                  LARGE_INTEGER frequency;
+                  QueryPerformanceFrequency(&frequency);
+                  ticksToMicroseconds = 1000000.0 / (double)frequency.QuadPart;
+               }
+               _MESSAGE("Model load benchmark: loading %u models, %u times each per pass...", (UInt32)paths.size(), iterations);
+               for (auto& path : paths) {
+                  double cold        = 0.0;
+                  double reloadTotal = 0.0;
+                  double warmTotal   = 0.0;
+                  UInt32 nodes       = 0;
+                  for (UInt32 i = 0; i < iterations; ++i) {
+                     NiPointer<NiNode> content = nullptr; // released at the end of each iteration
+                     auto s = Benchmark::_load(path.c_str(), content, ticksToMicroseconds);
+                     Benchmark::_write(csv, path, i ? "reload" : "cold", i, s);
+                     if (i == 0)
+                        cold = s.microseconds;
+                     else
+                        reloadTotal += s.microseconds;
+                     nodes = s.nodes;
+                  }
+                  {
+                     NiPointer<NiNode> held = nullptr;
+                     Benchmark::_load(path.c_str(), held, ticksToMicroseconds);
+                     for (UInt32 i = 0; i < iterations; ++i) {
+                        NiPointer<NiNode> content = nullptr;
+                        auto s = Benchmark::_load(path.c_str(), content, ticksToMicroseconds);
+                        Benchmark::_write(csv, path, "warm", i, s);
+                        warmTotal += s.microseconds;
+                     }
+                  }
+                  if (iterations > 1)
+                     _MESSAGE(" - %s: %u objects; cold load %.1f us; average re-load %.1f us; average warm %.1f us.", path.c_str(), nodes, cold, reloadTotal / (iterations - 1), warmTotal / iterations);
+                  else
+                     _MESSAGE(" - %s: %u objects; cold load %.1f us; average warm %.1f us.", path.c_str(), nodes, cold, warmTotal / iterations);
+               }
+               _MESSAGE("Model load benchmark complete. Results were written to CobbBugFixes_ModelBenchmark.csv.");
+            }
          }
       }
    }
@@ -1,9 +1,18 @@
 #pragma once
+
 namespace CobbBugFixes {
    namespace Patches {
       namespace Exploratory {
          namespace ModelLoadingTest {
             void RunTest();
+            //
+            // Loads each model listed in Data\SKSE\Plugins\CobbBugFixes_ModelBenchmark.txt (one 
+            // path per line, relative to the Meshes folder; blank lines and lines starting with 
+            // ';' are skipped) several times, and writes the load times, node counts, and memory 
+            // deltas to CobbBugFixes_ModelBenchmark.csv in the same folder. Runs at most once per 
+            // session, and only if enabled in the INI. Must be called on the main thread.
+            //
+            void RunBenchmark();
          }
       }
    }
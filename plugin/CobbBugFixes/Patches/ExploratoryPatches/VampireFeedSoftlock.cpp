@@ -3,6 +3,7 @@
 #include "ReverseEngineered/Forms/TESPackage.h"
 #include "ReverseEngineered/Player/PlayerCharacter.h"
 #include "ReverseEngineered/Systems/BSTEvent.h"
+#include "Services/Trace.h"
 #include "skse/SafeWrite.h"
 
 struct _PackageListener : RE::BSTEventSink<RE::TESPackageEvent> {
@@ -69,9 +70,11 @@ namespace CobbBugFixes {
                void _stdcall Inner(RE::Actor* actor, const char** eventName) {
                   if (actor != (RE::Actor*) *g_thePlayer)
                      return;
-                  _MESSAGE("Intercepted BSTEventSink<BSAnimationGraphEvent>::Subroutine006D21F0 on the player.");
-                  if (eventName && *eventName)
-                     _MESSAGE(" - Animation event is: %s", *eventName);
+                  if (auto entry = Trace::Begin(Trace::Event::vampire_feed_anim_event)) {
+                     entry->data.u[0] = actor->formID;
+                     if (eventName && *eventName)
+                        entry.WriteString(1, *eventName);
+                  }
                }
                __declspec(naked) void Outer() {
                   _asm {
@@ -1,79 +1,126 @@
 #include "MerchantRestockFix.h"
 #include "ReverseEngineered\Forms\TESFaction.h"
 #include "ReverseEngineered\Systems/GameData.h"
+#include "Services/CoSave.h"
+#include "Services/FormIndex.h"
 #include "Services/INI.h"
 //
 #include "skse/SafeWrite.h"
-#include "skse/Serialization.h"
-#include "skse/GameRTTI.h"
 
 #include <vector>
 
-struct _TempEntry {
+struct _TempEntry { // on-disk layout; written and read in bulk
    UInt32 formID;
    UInt32 days;
    //
+   _TempEntry() {}
    _TempEntry(UInt32 a, UInt32 b) : formID(a), days(b) {}
 };
+static_assert(sizeof(_TempEntry) == 8, "The merchant restock record layout must not change without a version bump.");
 
-bool MerchantRestockFix::Save(SKSESerializationInterface* intfc) {
-   using namespace Serialization;
+static CobbBugFixes::CoSave::RecordCodec s_codec("merchant restock fix", MerchantRestockFix::ce_recordSignature, MerchantRestockFix::kSaveVersion, &MerchantRestockFix::Save, &MerchantRestockFix::Load);
+
+namespace {
    //
-   auto  dh   = RE::DataHandler::GetSingleton();
-   auto& list = dh->factions;
+   // Walking every faction in the load order on every save is wasteful, since only vendor 
+   // factions matter and whether a faction is a vendor is fixed once the game data has been 
+   // loaded. We build an index of vendor factions once, after DataLoaded, and remember the 
+   // last restock day we saw for each. On save, we only rebuild the list of entries to be 
+   // written if one of those values has changed; otherwise we write the previous list as-is.
    //
-   std::vector<_TempEntry> map;
+   // (We don't know of a single place where the game writes vendorData.lastReset, so we 
+   // detect changes by comparing against the cached values rather than with a hook.)
    //
-   for (UInt32 i = 0; i < list.count; i++) {
-      auto faction = (RE::TESFaction*) list.arr.entries[i];
-      if (faction && faction->vendorData.merchantContainer) {
-         auto days = faction->vendorData.lastReset;
-         if (days != 0xFFFFFFFF)
-            map.emplace_back(faction->formID, days);
+   struct _VendorIndex {
+      struct Slot {
+         RE::TESFaction* faction;
+         UInt32 days; // lastReset as of the previous save
+      };
+      std::vector<Slot>       slots;
+      std::vector<_TempEntry> entries; // flat (formID, days) list of vendors that have restocked; written in bulk
+      bool built = false;
+      //
+      void Build() {
+         auto  dh   = RE::DataHandler::GetSingleton();
+         auto& list = dh->factions;
+         //
+         this->slots.clear();
+         for (UInt32 i = 0; i < list.count; i++) {
+            auto faction = (RE::TESFaction*) list.arr.entries[i];
+            if (faction && faction->vendorData.merchantContainer)
+               this->slots.push_back({ faction, 0xFFFFFFFF });
+         }
+         this->slots.shrink_to_fit();
+         this->entries.clear();
+         this->entries.reserve(this->slots.size());
+         this->built = true;
+         _MESSAGE("Merchant restock fix: indexed %u vendor factions out of %u factions total.", this->slots.size(), list.count);
       }
-   }
-   auto count = map.size();
-   if (!count)
-      return true;
-   if (intfc->OpenRecord(ce_recordSignature, kSaveVersion)) {
-      intfc->WriteRecordData(&count, sizeof(count));
-      for (auto it = map.begin(); it != map.end(); ++it) {
-         FormID id   = (*it).formID;
-         UInt32 days = (*it).days;
-         WriteData(intfc, &id);
-         WriteData(intfc, &days);
+      UInt32 Refresh() { // returns the number of vendors whose restock day changed since the last call
+         UInt32 changed = 0;
+         for (auto& slot : this->slots) {
+            auto days = slot.faction->vendorData.lastReset;
+            if (days != slot.days) {
+               slot.days = days;
+               ++changed;
+            }
+         }
+         if (changed) {
+            this->entries.clear();
+            for (auto& slot : this->slots)
+               if (slot.days != 0xFFFFFFFF)
+                  this->entries.emplace_back(slot.faction->formID, slot.days);
+         }
+         return changed;
       }
+   };
+   _VendorIndex s_vendors;
+   CobbBugFixes::FormIndex<RE::TESFaction> s_factions; // all factions, for resolving loaded form IDs without per-record lookups and casts
+
+   void _buildFactionIndex() {
+      auto& list = RE::DataHandler::GetSingleton()->factions;
+      s_factions.Build((RE::TESFaction* const*) list.arr.entries, list.count);
    }
+}
+
+void MerchantRestockFix::OnDataLoaded() {
+   s_vendors.Build();
+   _buildFactionIndex();
+}
+bool MerchantRestockFix::Save(SKSESerializationInterface* intfc) {
+   if (!s_vendors.built)
+      s_vendors.Build();
+   s_vendors.Refresh();
+   auto& entries = s_vendors.entries;
+   if (entries.empty())
+      return true;
+   if (intfc->OpenRecord(ce_recordSignature, kSaveVersion))
+      return CobbBugFixes::CoSave::WriteArray(intfc, entries);
    return true;
 }
-bool MerchantRestockFix::Load(SKSESerializationInterface* intfc, UInt32 version) {
-   using namespace Serialization;
-   //
+bool MerchantRestockFix::Load(CobbBugFixes::CoSave::RecordReader& reader) {
    if (CobbBugFixes::INI::MerchantRestockFixes::Enabled.bCurrent == false)
       return true;
    //
-   UInt32 count = 0;
-   if (!ReadData(intfc, &count)) {
-      _MESSAGE(__FUNCTION__ ": Failed to read the faction count.");
+   std::vector<_TempEntry> entries;
+   if (!reader.ReadArray(entries)) {
+      _MESSAGE(__FUNCTION__ ": Failed to read the faction list; the record is truncated or corrupt.");
       return false;
    }
-   for (UInt32 i = 0; i < count; i++) {
-      FormID id;
-      SInt32 days;
-      if (!ReadData(intfc, &id) || !ReadData(intfc, &days)) {
-         _MESSAGE(__FUNCTION__ ": Failed to read record %i.", i);
-         return false;
-      }
-      if (!intfc->ResolveFormId(id, &id)) {
-         _MESSAGE(__FUNCTION__ ": Skipping form ID %08X; the mod that defined this faction appears to have been removed.");
+   UInt32 missing = CobbBugFixes::CoSave::ResolveFormIDs(reader.Interface(), entries, &_TempEntry::formID);
+   if (missing)
+      _MESSAGE(__FUNCTION__ ": Skipping %u factions; the mods that defined them appear to have been removed.", missing);
+   if (!s_factions.IsBuilt())
+      _buildFactionIndex();
+   for (auto& entry : entries) {
+      if (!entry.formID)
          continue;
-      }
-      auto faction = (RE::TESFaction*) DYNAMIC_CAST(LookupFormByID(id), TESForm, TESFaction);
+      auto faction = s_factions.Lookup(entry.formID);
       if (!faction) {
-         _MESSAGE(__FUNCTION__ ": Skipping form ID %08X; the mod that defined this faction appears to have changed, and the form ID is now being used by something else.");
+         _MESSAGE(__FUNCTION__ ": Skipping form ID %08X; the mod that defined this faction appears to have changed, and the form ID is now being used by something else.", entry.formID);
          continue;
       }
-      faction->vendorData.lastReset = days;
+      faction->vendorData.lastReset = entry.days;
    }
    return true;
 }
\ No newline at end of file
@@ -2,12 +2,14 @@
 #include <map>
 #include <mutex>
 #include "skse/PluginAPI.h"
+#include "Services/CoSave.h"
 
 namespace MerchantRestockFix {
    typedef UInt32 FormID;
    //
    enum { kSaveVersion = 1 };
    static constexpr UInt32 ce_recordSignature = 'Mrch';
+   void OnDataLoaded(); // builds the vendor faction index
    bool Save(SKSESerializationInterface* intfc);
-   bool Load(SKSESerializationInterface* intfc, UInt32 version);
+   bool Load(CobbBugFixes::CoSave::RecordReader& reader);
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "ReverseEngineered/Systems/Inventory.h"
 
 #include "Services/INI.h"
+#include "ModArmorWeightPerkMath.h"
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -25,6 +26,15 @@ namespace CobbBugFixes {
             //
             // Our solution is to patch the former loop to use similar logic to the latter loop.
             //
+            // We don't cache the perk's result. The game already keeps each container's total 
+            // weight in ExtraContainerChanges::Data, and only walks the items again once a change 
+            // to the inventory has marked that total stale; the perk runs only during that walk, 
+            // so it always sees the current perks and conditions. A memo keyed by actor, armor, 
+            // and a perk-state generation was tried and withdrawn: a perk's conditions can test 
+            // state that no event reports (e.g. the time of day, or a quest variable), so there 
+            // is nothing that could reliably bump the generation, and the memo would then serve 
+            // stale weights in the very menus it was meant to speed up.
+            //
             void _stdcall Inner(RE::Actor* subject, RE::InventoryEntryData* entry, float weight, float& total, UInt32& count) {
                auto form = entry->type;
                if (!form || form->formType != kFormType_Armor)
@@ -93,21 +103,39 @@ namespace CobbBugFixes {
             // of the Steed Stone making an entire stack of an item weightless. The solution is 
             // to use a different float that is initialized to be a copy of item_weight.
             //
-            static float f_weight;
+            // That copy is thread-local; see Math::WeightSlot. Naked functions can't address 
+            // thread-local variables directly, so we go through a pair of helpers.
+            //
+            namespace WeightSlot {
+               float* _stdcall Begin(float weight) {
+                  return Math::WeightSlot::Begin(weight);
+               }
+               float _stdcall Read() {
+                  return Math::WeightSlot::Read();
+               }
+            }
             __declspec(naked) void OuterArg() {
                _asm {
-                  mov  eax, dword ptr [esp + 0x14];
-                  mov  [f_weight], eax;
-                  lea  eax, f_weight; // replace instruction
-                  push eax; // reproduce patched-over instruction
+                  push ecx; // protect
+                  push edx; // protect
+                  mov  eax, dword ptr [esp + 0x1C]; // item weight: &esp14 + 8
+                  push eax;
+                  call WeightSlot::Begin; // stdcall
+                  pop  edx; // restore
+                  pop  ecx; // restore
+                  push eax; // replace patched-over instruction
                   mov  eax, 0x0047B7D5;
                   jmp  eax;
                }
             }
             __declspec(naked) void OuterAfter() {
                _asm {
-                  fld  dword ptr [esp + 0x30]; // reproduce patched-over instruction
-                  fadd dword ptr [f_weight];
+                  push ecx; // protect
+                  push edx; // protect
+                  call WeightSlot::Read; // stdcall; result is on the FPU stack
+                  pop  edx; // restore
+                  pop  ecx; // restore
+                  fadd dword ptr [esp + 0x30]; // reproduce patched-over instructions (operands reversed)
                   mov  eax, 0x0047B7E6;
                   jmp  eax;
                }
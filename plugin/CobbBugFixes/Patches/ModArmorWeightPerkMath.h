@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+//
+// The weight accounting behind the Mod Armor Weight stack fix, kept free of any dependency
+// on the game or on SKSE so that it can be compiled and tested on its own. The patch in
+// ModArmorWeightPerk.cpp hands the perk entry point a WeightSlot copy of the item weight and
+// reads the copy back afterward; see the comments there for the bug itself.
+//
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace ModArmorWeightPerk {
+         namespace Math {
+            //
+            // GetTotalWeight can run on AI threads as well as the main thread, so the copy of
+            // the item weight is thread-local: two threads computing weights at once each get
+            // their own.
+            //
+            namespace WeightSlot {
+               inline float& Slot() {
+                  static thread_local float s_weight;
+                  return s_weight;
+               }
+               inline float* Begin(float weight) { // copies the item weight and returns the address to hand to the perk entry point
+                  float& slot = Slot();
+                  slot = weight;
+                  return &slot;
+               }
+               inline float Read() { // returns the perk-modified copy
+                  return Slot();
+               }
+            }
+
+            //
+            // The fixed accounting for one stack in GetTotalWeight's second loop: if one of the
+            // (count) items is worn, the perk applies to that one alone. (perk) modifies the
+            // weight it's given in place, as CalculatePerkData does. The patch splits this
+            // across two hooks, but the order of operations is the same.
+            //
+            template<typename Perk> float StackWeight(float weight, uint32_t count, bool worn, Perk&& perk) {
+               float total = 0.0F;
+               if (worn && count) {
+                  perk(WeightSlot::Begin(weight));
+                  total += WeightSlot::Read();
+                  --count;
+               }
+               return total + weight * count;
+            }
+         }
+      }
+   }
+}
@@ -2,7 +2,11 @@
 #include "skse/SafeWrite.h"
 #include "ReverseEngineered/Forms/TESForm.h"
 
+#include "Services/Diagnostics.h"
 #include "Services/INI.h"
+#include <algorithm>
+#include <cstddef> // offsetof
+#include <string>
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -25,33 +29,154 @@ namespace CobbBugFixes {
          // someone makes a torch that is *actually* set to not light the landscape, we're gonna 
          // make it light the landscape anyway.
          //
-         UInt32 _stdcall Inner(RE::TESForm* lightSource) {
-            //
-            // We patch halfway into the destructor, before most fields are cleared. 
-            // It is safe to access most, maybe all, of TESPackage's fields.
-            //
-            if (lightSource->formType == 0x3E)
-               return 0;
-            return (lightSource->flags >> 0x11); // reproduce patched-over opcode (check for "doesn't light landscape" flag) but, only conditionally
-         }
+         // This runs for every light reference whenever lighting is set up, so the check is 
+         // done inline in the patch itself: no call out to C++, and no stack traffic. Register 
+         // ebp holds the light source. There are no registers free to jump back with, so we 
+         // return through an indirect jump on a memory operand.
+         //
+         static_assert(offsetof(RE::TESForm, flags)    == 0x08, "The patch below assumes this layout.");
+         static_assert(offsetof(RE::TESForm, formType) == 0x12, "The patch below assumes this layout.");
+         //
+         static const UInt32 s_return = 0x0049E013;
          __declspec(naked) void Outer() {
             _asm {
-               push eax; // protect
-               push edx; // protect
-               push ebp;
-               call Inner; // stdcall
-               mov  ecx, eax;
-               pop  edx; // restore
-               pop  eax; // restore
+               cmp  byte ptr [ebp + 0x12], 0x3E; // if (lightSource->formType == kFormType_Character)
+               jne  lNotActor;
+               xor  ecx, ecx;                    //    ecx = 0;
+               jmp  lExit;                       // else
+            lNotActor:
+               mov  ecx, dword ptr [ebp + 0x08]; //    ecx = lightSource->flags >> 0x11; // the "doesn't light landscape" flag
+               shr  ecx, 0x11;                   //
+            lExit:
                shr  eax, 8; // reproduce patched-over opcode
-               retn;
+               jmp  dword ptr [s_return];
+            }
+         }
+         namespace Audit {
+            //
+            // Optional diagnostic: counts how many light sources pass through the lighting setup 
+            // function in each frame, how many of those are actor-held torches, and how many 
+            // have the "doesn't light landscape" flag (before our fix ignores it). The averages 
+            // and peaks in each report cover the frames since the previous report; the histogram 
+            // of lights per frame is a rolling one, covering the most recent ce_windowFrames 
+            // frames whatever the report boundaries, so that we can see the lighting load of 
+            // busy cells.
+            //
+            // Lighting setup can run on more than one thread. Only frames in which any lighting 
+            // setup ran are counted.
+            //
+            constexpr UInt32 ce_bucketCount  = 10;   // light counts of 1, 2-3, 4-7, ... 256-511, and 512+
+            constexpr UInt32 ce_windowFrames = 3600; // about a minute at 60FPS
+            //
+            static Diagnostics::Counter s_lights;
+            static Diagnostics::Counter s_torches;
+            static Diagnostics::Counter s_noLandscape;
+            static Diagnostics::FrameDetector s_frame;
+            static Diagnostics::ReportGate    s_gate(30 * 1000);
+            //
+            struct Summary {
+               Diagnostics::FrameSeries<UInt32> lights;
+               Diagnostics::FrameSeries<UInt32> torches;
+               UInt32 noLandscape = 0;
+            };
+            struct Histogram {
+               UInt8  window[ce_windowFrames] = {}; // bucket index of each frame in the window, as a ring
+               UInt32 next    = 0; // total number of frames ever added
+               UInt32 buckets[ce_bucketCount] = {};
+               //
+               void Add(UInt32 bucket) {
+                  auto& slot = this->window[this->next % ce_windowFrames];
+                  if (this->next >= ce_windowFrames)
+                     --this->buckets[slot]; // the oldest frame leaves the window
+                  slot = (UInt8)bucket;
+                  ++this->buckets[bucket];
+                  ++this->next;
+               }
+               UInt32 Frames() const {
+                  return (std::min)(this->next, ce_windowFrames);
+               }
+            };
+            static Summary   s_summary;   // only touched by the thread that closes out a frame
+            static Histogram s_histogram; // likewise; never reset
+
+            UInt32 _bucket(UInt32 lights) {
+               UInt32 i = 0;
+               while (lights > 1 && i < ce_bucketCount - 1) {
+                  lights >>= 1;
+                  ++i;
+               }
+               return i;
+            }
+            void _report() {
+               auto& s = s_summary;
+               auto& h = s_histogram;
+               if (UInt32 frames = s.lights.frames) {
+                  std::string histogram;
+                  char buffer[32];
+                  for (UInt32 i = 0; i < ce_bucketCount; ++i) {
+                     if (i < ce_bucketCount - 1)
+                        snprintf(buffer, sizeof(buffer), " [%u-%u]:%u", 1 << i, (2 << i) - 1, h.buckets[i]);
+                     else
+                        snprintf(buffer, sizeof(buffer), " [%u+]:%u", 1 << i, h.buckets[i]);
+                     histogram += buffer;
+                  }
+                  _MESSAGE("Lighting audit over %u frames with lighting setup: %.1f lights per frame (peak %u); %.1f actor-held torches per frame (peak %u); %.1f lights per frame flagged as not lighting the landscape.", frames, s.lights.Average(), s.lights.peak, s.torches.Average(), s.torches.peak, (double)s.noLandscape / frames);
+                  _MESSAGE(" - Lights per frame over the last %u frames with lighting setup:%s", h.Frames(), histogram.c_str());
+               }
+               s = Summary();
+            }
+            void _closeFrame() {
+               UInt32 lights      = s_lights.Take();
+               UInt32 torches     = s_torches.Take();
+               UInt32 noLandscape = s_noLandscape.Take();
+               auto&  s = s_summary;
+               if (lights) {
+                  s.lights.Add(lights);
+                  s.torches.Add(torches);
+                  s.noLandscape += noLandscape;
+                  s_histogram.Add(_bucket(lights));
+               }
+               if (s_gate.Due())
+                  _report();
+            }
+            void _stdcall Inner(RE::TESForm* lightSource) {
+               if (s_frame.NewFrame())
+                  _closeFrame();
+               ++s_lights;
+               if (lightSource->formType == 0x3E)
+                  ++s_torches;
+               if (lightSource->flags & 0x00020000)
+                  ++s_noLandscape;
+            }
+            __declspec(naked) void Outer() {
+               _asm {
+                  push eax; // protect
+                  push edx; // protect
+                  push ebp;
+                  call Inner; // stdcall
+                  pop  edx; // restore
+                  pop  eax; // restore
+                  cmp  byte ptr [ebp + 0x12], 0x3E; // same as the non-audit patch
+                  jne  lNotActor;
+                  xor  ecx, ecx;
+                  jmp  lExit;
+               lNotActor:
+                  mov  ecx, dword ptr [ebp + 0x08];
+                  shr  ecx, 0x11;
+               lExit:
+                  shr  eax, 8; // reproduce patched-over opcode
+                  jmp  dword ptr [s_return];
+               }
             }
          }
          void Apply() {
             if (CobbBugFixes::INI::NPCTorchLandscapeFix::Enabled.bCurrent == false)
                return;
-            WriteRelCall(0x0049E00D, (UInt32)&Outer); // use a call since there are no registers available to jump back with // circa TESObjectLIGH::sub0049DC10+3FF
-            SafeWrite8(0x0049E00D + 5, 0x90); // this NOP is REQUIRED since we're using a call
+            if (CobbBugFixes::INI::NPCTorchLandscapeFix::AuditLighting.bCurrent)
+               WriteRelJump(0x0049E00D, (UInt32)&Audit::Outer);
+            else
+               WriteRelJump(0x0049E00D, (UInt32)&Outer); // circa TESObjectLIGH::sub0049DC10+3FF
+            SafeWrite8(0x0049E00D + 5, 0x90); // NOP
          }
       }
    }
@@ -0,0 +1,181 @@
+#include "PlayerAIDrivenRecovery.h"
+#include "ReverseEngineered/Forms/TESPackage.h"
+#include "ReverseEngineered/Player/PlayerCharacter.h"
+#include "ReverseEngineered/Systems/012E32E8.h" // g_globalActorTimer
+#include "skse/GameAPI.h" // Console_Print
+#include "skse/ObScript.h"
+#include "skse/SafeWrite.h"
+#include <cstring>
+
+#include "Services/INI.h"
+#include "Services/PlayerAIDriven.h"
+
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace PlayerAIDrivenRecovery {
+         //
+         // When the player is "AI-driven" (flag 0x08 on PlayerCharacter::unk726), they can't
+         // move or turn; the game is driving them with an AI package, as it would an NPC. The
+         // only way out is for something to call SetPlayerAIDriven(false). The vampire-feed
+         // softlock is one case where that never happens, but mods and other engine bugs can
+         // leave the player stuck the same way.
+         //
+         // Rather than hook every place that can start or end an AI package, we rely on the 
+         // polling in PlayerAIDriven, which runs our check on the main thread while the player 
+         // is AI-driven. Each transition into or out of the AI-driven state is recorded in a 
+         // small ring buffer, along with the package the player was running at the time, and 
+         // the history is written into crash logs and can optionally be printed with a console 
+         // command. Since the state is polled, a transition is recorded when a poll notices it, 
+         // not when it happens, and a spell of AI-driven state shorter than the poll interval 
+         // may not be recorded at all; the history says so wherever it's shown. If the player 
+         // stays AI-driven without any package for long enough (measured in actor time, so 
+         // menus and pausing don't count), we release them.
+         //
+         constexpr UInt32 ce_historySize = 32;
+         //
+         enum class Kind : UInt8 {
+            none,
+            entered,
+            exited,
+            recovered,
+         };
+         struct Transition {
+            DWORD  tick       = 0;   // GetTickCount
+            float  actorTime  = 0.0F;
+            Kind   kind       = Kind::none;
+            UInt8  packageType = 0;
+            UInt32 packageID  = 0;   // form ID of the player's package at the time, if any
+         };
+         static Transition s_history[ce_historySize]; // only written on the main thread
+         static UInt32     s_historyNext = 0; // total number of transitions ever recorded
+         //
+         static bool  s_wasDriven  = false;
+         static float s_stuckSince = -1.0F; // actor time at which we first saw the player AI-driven with no package
+
+         void _record(Kind kind, RE::TESPackage* package) {
+            Transition t;
+            t.tick      = GetTickCount();
+            t.actorTime = *RE::g_globalActorTimer;
+            t.kind      = kind;
+            if (package) {
+               t.packageType = package->type;
+               t.packageID   = package->formID;
+            }
+            s_history[s_historyNext % ce_historySize] = t;
+            ++s_historyNext;
+         }
+         const char* _kindName(Kind k) {
+            switch (k) {
+               case Kind::entered:   return "entered";
+               case Kind::exited:    return "exited";
+               case Kind::recovered: return "recovered (released by us)";
+            }
+            return "?";
+         }
+         //
+         // Calls (functor) on each recorded transition, oldest first. Doesn't lock, so that the
+         // crash logger can use it from any thread.
+         //
+         template<typename F> void _forEachTransition(F functor) {
+            UInt32 end   = s_historyNext;
+            UInt32 start = end > ce_historySize ? end - ce_historySize : 0;
+            for (UInt32 i = start; i < end; ++i)
+               functor(s_history[i % ce_historySize]);
+         }
+
+         void Check(bool driven) { // main thread, via PlayerAIDriven
+            auto player = *RE::g_thePlayer;
+            if (!player)
+               return;
+            auto  package = PlayerAIDriven::GetPackage(player);
+            float now     = *RE::g_globalActorTimer;
+            if (driven != s_wasDriven) {
+               _record(driven ? Kind::entered : Kind::exited, package);
+               s_wasDriven = driven;
+            }
+            if (!driven || package) {
+               s_stuckSince = -1.0F;
+               return;
+            }
+            if (s_stuckSince < 0.0F || now < s_stuckSince) { // just got stuck, or the actor timer was reset by a load
+               s_stuckSince = now;
+               return;
+            }
+            if (now - s_stuckSince >= (float)INI::PlayerAIDrivenRecovery::StuckSeconds.uCurrent) {
+               _MESSAGE("The player has been AI-driven with no AI package for too long. Releasing them.");
+               PlayerAIDriven::Release();
+               _record(Kind::recovered, nullptr);
+               s_wasDriven  = false;
+               s_stuckSince = -1.0F;
+            }
+         }
+
+         namespace ConsoleCommand {
+            //
+            // Classic SKSE has no API for adding console commands, so we take over one that
+            // the retail game leaves unused. Other mods may do the same, so this is opt-in.
+            //
+            static const char* ce_candidates[] = { "TestSeenData", "DumpNiUpdates" };
+            //
+            bool Execute(const ObScriptParam* paramInfo, ScriptData* scriptData, TESObjectREFR* thisObj, TESObjectREFR* containingObj, Script* scriptObj, ScriptLocals* locals, double& result, UInt32& opcodeOffsetPtr) {
+               auto player = *RE::g_thePlayer;
+               if (player)
+                  Console_Print("The player is currently %s.", (player->unk726 & 8) ? "AI-driven" : "not AI-driven");
+               UInt32 count = 0;
+               _forEachTransition([&count](const Transition& t) {
+                  ++count;
+                  Console_Print(" - [%10u ms | actor time %.2f] %s; package %08X (type %u)", t.tick, t.actorTime, _kindName(t.kind), t.packageID, t.packageType);
+               });
+               if (!count)
+                  Console_Print("No AI-driven state transitions have been recorded this session.");
+               Console_Print("The state is checked every %u ms; shorter changes may be missing from this list.", PlayerAIDriven::ce_pollInterval);
+               return true;
+            }
+            void Apply() {
+               for (UInt32 i = 0; i < kObScript_NumConsoleCommands; ++i) {
+                  auto command = &g_firstConsoleCommand[i];
+                  if (!command->longName)
+                     continue;
+                  for (auto name : ce_candidates) {
+                     if (_stricmp(command->longName, name) != 0)
+                        continue;
+                     ObScriptCommand replacement = *command;
+                     replacement.longName    = "CobbAIDrivenHistory";
+                     replacement.shortName   = "";
+                     replacement.helpText    = "Lists recent changes to the player's AI-driven state.";
+                     replacement.needsParent = 0;
+                     replacement.numParams   = 0;
+                     replacement.params      = nullptr;
+                     replacement.execute     = Execute;
+                     replacement.flags       = 0;
+                     SafeWriteBuf((UInt32)command, &replacement, sizeof(replacement));
+                     _MESSAGE("Replaced the unused console command %s with CobbAIDrivenHistory.", name);
+                     return;
+                  }
+               }
+               _MESSAGE("Couldn't find an unused console command to replace; CobbAIDrivenHistory won't be available.");
+            }
+         }
+
+         void Apply() {
+            if (INI::PlayerAIDrivenRecovery::Enabled.bCurrent == false)
+               return;
+            PlayerAIDriven::Watch(&Check);
+            if (INI::PlayerAIDrivenRecovery::ConsoleCommand.bCurrent)
+               ConsoleCommand::Apply();
+         }
+         void LogHistory() {
+            if (INI::PlayerAIDrivenRecovery::Enabled.bCurrent == false)
+               return;
+            _MESSAGE("\nPLAYER AI-DRIVEN STATE HISTORY (oldest first; polled every %u ms, so shorter changes may be missing):", PlayerAIDriven::ce_pollInterval);
+            UInt32 count = 0;
+            _forEachTransition([&count](const Transition& t) {
+               ++count;
+               _MESSAGE(" - [%10u ms | actor time %.2f] %s; package %08X (type %u)", t.tick, t.actorTime, _kindName(t.kind), t.packageID, t.packageType);
+            });
+            if (!count)
+               _MESSAGE(" - No transitions recorded.");
+         }
+      }
+   }
+}
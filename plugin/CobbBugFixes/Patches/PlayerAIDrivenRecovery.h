@@ -0,0 +1,10 @@
+#pragma once
+
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace PlayerAIDrivenRecovery {
+         void Apply();
+         void LogHistory(); // writes recent AI-driven state transitions to the log; used by the crash logger
+      }
+   }
+}
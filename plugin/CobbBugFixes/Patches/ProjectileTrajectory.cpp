@@ -0,0 +1,125 @@
+#include "ProjectileTrajectory.h"
+#include "ReverseEngineered/NetImmerse/nodes.h"
+#include "ReverseEngineered/NetImmerse/types.h"
+#include "skse/NiNodes.h"
+#include "skse/SafeWrite.h"
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace ProjectileTrajectory {
+         //
+         // TESObjectREFR::AdjustProjectileFireTrajectory reads the pitch and yaw out of the
+         // firing node's world rotation and writes them to its arguments. It copies its
+         // arguments into registers and then overwrites them, so there's nowhere partway
+         // through for a hook to catch them; we replace the whole function, reproduce the
+         // vanilla behavior, and then run the adjusters.
+         //
+         // The vanilla-derived direction is computed in closed form rather than by building
+         // a rotation matrix from the Euler angles and taking its forward row: with no roll,
+         // the forward vector is just (sin yaw * cos pitch, cos yaw * cos pitch, -sin pitch),
+         // which is a handful of instructions.
+         //
+         // The list of adjusters is copy-on-write: registering one swaps in a new list, and
+         // the hook takes a reference to the current list under the lock but runs the
+         // adjusters outside of it. That way, an adjuster can register another adjuster (or
+         // send us a message that does) without deadlocking, and registering never modifies
+         // a list that another thread is walking.
+         //
+         struct _Registered {
+            Adjuster adjuster;
+            void*    context;
+         };
+         typedef std::vector<_Registered> _List;
+         static std::shared_ptr<const _List> s_adjusters;
+         static std::mutex        s_lock;
+         static std::atomic<bool> s_any(false); // lets the hook skip the lock while nothing is registered
+
+         void _stdcall Inner(void* shooter, NiNode* node, float* pitch, float* yaw, NiPoint3* position) {
+            {  // Reproduce vanilla code
+               struct Shim {
+                  DEFINE_MEMBER_FN_LONG(Shim, Subroutine00AAD320, void, 0x00AAD320, float*, float*, float*);
+               };
+               auto  p = (Shim*)&node->m_worldTransform;
+               float roll;
+               CALL_MEMBER_FN(p, Subroutine00AAD320)(yaw, pitch, &roll);
+            }
+            FireData data;
+            data.shooter = shooter;
+            data.node    = node;
+            data.pitch   = *pitch;
+            data.yaw     = *yaw;
+            data.position[0] = position->x;
+            data.position[1] = position->y;
+            data.position[2] = position->z;
+            {
+               float cp = std::cos(data.pitch);
+               data.forward[0] = std::sin(data.yaw) * cp;
+               data.forward[1] = std::cos(data.yaw) * cp;
+               data.forward[2] = -std::sin(data.pitch);
+            }
+            if (!s_any)
+               return;
+            std::shared_ptr<const _List> adjusters;
+            {
+               std::lock_guard<std::mutex> guard(s_lock);
+               adjusters = s_adjusters;
+            }
+            for (auto& entry : *adjusters)
+               entry.adjuster(data, entry.context);
+            *pitch = data.pitch;
+            *yaw   = data.yaw;
+            position->x = data.position[0];
+            position->y = data.position[1];
+            position->z = data.position[2];
+         }
+         __declspec(naked) void Outer() {
+            //
+            // The original is a member function (ecx) that takes four arguments and pops them
+            // itself. We pass (this) to Inner as an extra first argument; Inner then pops all
+            // five, which leaves the stack as the caller expects.
+            //
+            _asm {
+               pop  eax;  // return address
+               push ecx;  // this
+               push eax;
+               jmp  Inner; // stdcall
+            }
+         }
+         void Apply() {
+            WriteRelJump(0x004D6750, (UInt32)&Outer); // TESObjectREFR::AdjustProjectileFireTrajectory + 0x00
+         }
+
+         bool AddAdjuster(Adjuster adjuster, void* context) {
+            if (!adjuster)
+               return false;
+            std::lock_guard<std::mutex> guard(s_lock);
+            auto list = s_adjusters ? std::make_shared<_List>(*s_adjusters) : std::make_shared<_List>();
+            for (auto& entry : *list)
+               if (entry.adjuster == adjuster && entry.context == context)
+                  return false;
+            list->push_back({ adjuster, context });
+            s_adjusters = list;
+            s_any = true;
+            return true;
+         }
+         void OnMessage(const void* data, uint32_t dataLen) {
+            if (!data || dataLen < sizeof(Registration)) {
+               _MESSAGE("Ignoring a projectile trajectory adjuster registration: the message is too short.");
+               return;
+            }
+            auto reg = (const Registration*)data;
+            if (reg->version != ce_apiVersion) {
+               _MESSAGE("Ignoring a projectile trajectory adjuster registration: API version %u isn't supported (we support version %u).", reg->version, ce_apiVersion);
+               return;
+            }
+            if (AddAdjuster(reg->adjuster, reg->context))
+               _MESSAGE("Registered a projectile trajectory adjuster at %08X.", (UInt32)reg->adjuster);
+         }
+      }
+   }
+}
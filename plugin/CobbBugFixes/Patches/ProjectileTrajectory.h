@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+namespace CobbBugFixes {
+   namespace Patches {
+      namespace ProjectileTrajectory {
+         //
+         // Lets plug-ins adjust the initial position and direction of projectiles as they're
+         // fired, through a single hook on TESObjectREFR::AdjustProjectileFireTrajectory, rather
+         // than each of them patching the same function.
+         //
+         // This header has no dependencies on the game or on SKSE, so that other plug-ins can
+         // include it as-is. To register an adjuster from another plug-in, send us a message
+         // through the SKSE messaging interface once all plug-ins have loaded (i.e. in your
+         // handler for SKSE's PostLoad message):
+         //
+         //    CobbBugFixes::Patches::ProjectileTrajectory::Registration reg;
+         //    reg.adjuster = MyAdjuster;
+         //    reg.context  = nullptr;
+         //    messaging->Dispatch(myHandle, ce_registerMessage, &reg, sizeof(reg), "CobbBugFixes");
+         //
+         // The hook is installed when we load, before the game can be firing projectiles; until
+         // something registers, it only reproduces the game's own code. Adjusters run on whatever thread fires the projectile,
+         // in the order they were registered; each one sees the changes made by the ones before.
+         //
+         constexpr uint32_t ce_registerMessage = 'Traj';
+         constexpr uint32_t ce_apiVersion      = 1;
+
+         struct FireData {
+            void*    shooter;    // TESObjectREFR*; read-only
+            void*    node;       // the NiNode the projectile is fired from; read-only
+            float    forward[3]; // unit vector for the pitch and yaw below, as they were before any adjuster ran; read-only
+            float    pitch;      // radians; positive values aim downward
+            float    yaw;        // radians
+            float    position[3];
+         };
+         typedef void (*Adjuster)(FireData& data, void* context);
+
+         struct Registration {
+            uint32_t version  = ce_apiVersion;
+            Adjuster adjuster = nullptr;
+            void*    context  = nullptr;
+         };
+
+         void Apply();
+         bool AddAdjuster(Adjuster, void* context); // returns false if the adjuster was already registered with that context
+         void OnMessage(const void* data, uint32_t dataLen); // handles a Registration sent through SKSE messaging
+      }
+   }
+}
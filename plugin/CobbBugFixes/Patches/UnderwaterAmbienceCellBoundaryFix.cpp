@@ -3,10 +3,14 @@
 #include "ReverseEngineered/Forms/TESWorldSpace.h"
 #include "ReverseEngineered/NetImmerse/nodes.h"
 #include "ReverseEngineered/Player/PlayerCharacter.h"
+#include "ReverseEngineered/Systems/BSTEvent.h"
 #include "ReverseEngineered/Systems/TESCamera.h"
 #include "skse/SafeWrite.h"
 
+#include "Services/Diagnostics.h"
 #include "Services/INI.h"
+#include <cmath>
+#include <mutex>
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -21,6 +25,100 @@ namespace CobbBugFixes {
          //
          static bool s_isAutoWaterCheck = false;
          //
+         namespace WaterLevelCache {
+            //
+            // Our water-exit check runs constantly while the camera is underwater, and finding 
+            // the cell that contains the camera means a worldspace cell lookup each time. We 
+            // remember the last few results, keyed on the worldspace and the exterior cell grid 
+            // coordinates of the camera. Cell water heights can only change as cells load and 
+            // unload, so we drop everything whenever a cell attaches or detaches.
+            //
+            constexpr float  ce_cellSize = 4096.0F;
+            constexpr UInt32 ce_size     = 4;
+            //
+            struct Entry {
+               RE::TESWorldSpace*  world = nullptr;
+               SInt32 x = 0;
+               SInt32 y = 0;
+               RE::TESObjectCELL*  cell  = nullptr;
+               float  water = 0.0F;
+            };
+            static Entry      s_entries[ce_size]; // most recently used first
+            static std::mutex s_lock;
+            namespace Stats {
+               static Diagnostics::Counter s_checks;  // water-exit checks; without the cache, each of these would be a lookup
+               static Diagnostics::Counter s_lookups; // worldspace cell lookups we actually ran
+               static Diagnostics::ReportGate s_gate(60 * 1000);
+            }
+
+            void Clear() {
+               std::lock_guard<std::mutex> guard(s_lock);
+               for (auto& entry : s_entries)
+                  entry = Entry();
+            }
+            void _report() {
+               using namespace Stats;
+               if (!s_gate.Due())
+                  return;
+               UInt32 checks  = s_checks.Take();
+               UInt32 lookups = s_lookups.Take();
+               if (INI::UnderwaterAmbienceCellBoundaryFix::LogCacheStats.bCurrent && checks)
+                  _MESSAGE("Water level cache: %u water-exit checks needed %u worldspace cell lookups (one per check without the cache).", checks, lookups);
+            }
+            //
+            // Returns false if the worldspace has no cell at that point.
+            //
+            bool Get(RE::TESWorldSpace* world, RE::NiPoint3& pos, RE::TESObjectCELL*& outCell, float& outWater) {
+               SInt32 x = (SInt32)std::floor(pos.x / ce_cellSize);
+               SInt32 y = (SInt32)std::floor(pos.y / ce_cellSize);
+               std::lock_guard<std::mutex> guard(s_lock);
+               ++Stats::s_checks;
+               _report();
+               for (UInt32 i = 0; i < ce_size; ++i) {
+                  auto& entry = s_entries[i];
+                  if (entry.world == world && entry.x == x && entry.y == y) {
+                     Entry found = entry;
+                     for (; i > 0; --i)
+                        s_entries[i] = s_entries[i - 1];
+                     s_entries[0] = found;
+                     outCell  = found.cell;
+                     outWater = found.water;
+                     return true;
+                  }
+               }
+               ++Stats::s_lookups;
+               auto cell = CALL_MEMBER_FN(world, GetCellThatContainsPoint)(&pos);
+               if (!cell)
+                  return false;
+               Entry created;
+               created.world = world;
+               created.x     = x;
+               created.y     = y;
+               created.cell  = cell;
+               created.water = CALL_MEMBER_FN(cell, GetWaterLevel)();
+               for (UInt32 i = ce_size - 1; i > 0; --i)
+                  s_entries[i] = s_entries[i - 1];
+               s_entries[0] = created;
+               outCell  = cell;
+               outWater = created.water;
+               return true;
+            }
+
+            struct CellListener : RE::BSTEventSink<RE::TESCellAttachDetachEvent> {
+               virtual EventResult Handle(void* aEv, void* aSource) override {
+                  Clear();
+                  return EventResult::kEvent_Continue;
+               };
+               static CellListener* GetInstance() {
+                  static CellListener instance;
+                  return &instance;
+               };
+            };
+            void Register() {
+               auto holder = RE::BSTEventSourceHolder::GetOrCreate();
+               CALL_MEMBER_FN(&holder->cellAttachDetach, AddEventSink)(CellListener::GetInstance());
+            }
+         }
          __declspec(naked) void bhk_Outer() {
             _asm {
                mov  s_isAutoWaterCheck, 1;
@@ -68,15 +166,15 @@ namespace CobbBugFixes {
                      CALL_MEMBER_FN(camera, GetUnkB4OrEquivalent)(pos);
                   }
                }
-               cell = CALL_MEMBER_FN(world, GetCellThatContainsPoint)(&pos);
-               //*/
-               if (!cell)
+               float water;
+               if (!WaterLevelCache::Get(world, pos, cell, water)) {
                   //
                   // Prefer the cell containing the camera position, but if that's 
                   // not available, then use the player's cell.
                   //
-                  cell = player->parentCell;
-               float water = CALL_MEMBER_FN(cell, GetWaterLevel)();
+                  cell  = player->parentCell;
+                  water = CALL_MEMBER_FN(cell, GetWaterLevel)();
+               }
 //_MESSAGE("Camera: %f\n Water: %f", pos.z, water);
                float camZ = camera->unkB4.z;
                return camZ >= water;
@@ -143,6 +241,11 @@ namespace CobbBugFixes {
             UnderwaterFX::Apply();
             WriteRelJump(0x00633265, (UInt32)&bhk_Outer);
          };
+         void OnDataLoaded() {
+            if (CobbBugFixes::INI::UnderwaterAmbienceCellBoundaryFix::Enabled.bCurrent == false)
+               return;
+            WaterLevelCache::Register();
+         }
       }
    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@ namespace CobbBugFixes {
    namespace Patches {
       namespace UnderwaterAmbienceCellBoundaryFix {
          void Apply();
+         void OnDataLoaded(); // registers the event sink that invalidates our water level cache
       }
    }
 }
\ No newline at end of file
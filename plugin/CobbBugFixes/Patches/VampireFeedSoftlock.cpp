@@ -1,7 +1,12 @@
 #include "VampireFeedSoftlock.h"
 #include "ReverseEngineered/Forms/TESPackage.h"
 #include "ReverseEngineered/Player/PlayerCharacter.h"
+#include "ReverseEngineered/Systems/012E32E8.h" // g_globalActorTimer
 #include "skse/SafeWrite.h"
+#include <atomic>
+#include <cstring>
+
+#include "Services/PlayerAIDriven.h"
 
 namespace CobbBugFixes {
    namespace Patches {
@@ -56,6 +61,107 @@ namespace CobbBugFixes {
          //    the player is intentionally in an AI-driven state (i.e. due to a 
          //    mod that has put them there).
          //
+         // WATCHDOG
+         //    Whichever hook is in use always runs; the watchdog is an extra safety net for 
+         //    packages that go away by some path the hook doesn't catch. It's armed by a hook 
+         //    in the vampire-feed procedure itself, which only runs while some actor is 
+         //    feeding; it arms when the player is AI-driven and running a vampire-feed 
+         //    package, and refreshes a timestamp each time it runs thereafter.
+         //
+         //    While the player is AI-driven, PlayerAIDriven runs our check on the main thread 
+         //    twice a second. If the procedure has stopped running for long enough (measured 
+         //    in actor time, so menus and pausing don't count) and the player has no vampire-
+         //    feed package left, we release them. Once the player is no longer AI-driven, the 
+         //    watchdog disarms itself. Without SKSE's task interface, PlayerAIDriven can't run 
+         //    checks, so there's no watchdog.
+         //
+         bool IsFeeding(RE::Actor* actor) { // true if either of the actor's package slots holds a vampire-feed package
+            return PlayerAIDriven::HasPackageOfType(actor, RE::TESPackage::kPackageType_VampireFeed);
+         }
+
+         namespace Watchdog {
+            constexpr float ce_timeout = 5.0F; // seconds of actor time without the feed procedure running
+            //
+            static std::atomic<bool>   s_armed(false);
+            static std::atomic<UInt32> s_lastSeen(0); // bit pattern of the actor timer when the feed procedure last ran
+
+            inline float _now() {
+               return *RE::g_globalActorTimer;
+            }
+            inline UInt32 _bits(float f) {
+               UInt32 out;
+               memcpy(&out, &f, sizeof(out));
+               return out;
+            }
+            inline float _float(UInt32 u) {
+               float out;
+               memcpy(&out, &u, sizeof(out));
+               return out;
+            }
+            void Arm() {
+               s_lastSeen = _bits(_now());
+               s_armed    = true;
+            }
+            void Disarm() {
+               s_armed = false;
+            }
+            void Check(bool driven) { // main thread, via PlayerAIDriven
+               if (!s_armed)
+                  return;
+               if (!driven) { // feeding finished normally
+                  Disarm();
+                  return;
+               }
+               float elapsed = _now() - _float(s_lastSeen);
+               if (elapsed < 0.0F) { // the actor timer was reset, e.g. by loading a save
+                  s_lastSeen = _bits(_now());
+                  return;
+               }
+               if (elapsed < ce_timeout)
+                  return;
+               auto player = *RE::g_thePlayer;
+               if (!player || IsFeeding(player)) // still feeding, so keep watching
+                  return;
+               _MESSAGE("Vampire feed watchdog: the player's feeding package is gone but they're still AI-driven. Releasing them.");
+               PlayerAIDriven::Release();
+               Disarm();
+            }
+
+            namespace ProcedureHook {
+               void _stdcall Inner() {
+                  auto player = *RE::g_thePlayer;
+                  if (player && (player->unk726 & 8) && IsFeeding(player))
+                     Arm();
+               }
+               __declspec(naked) void Outer() {
+                  //
+                  // The patched-over call must see the stack exactly as the original code left 
+                  // it, so we make it before pushing anything. Afterward, only its result in 
+                  // eax matters; ecx and edx are caller-saved, so the original code doesn't 
+                  // expect anything of them after the call.
+                  //
+                  _asm {
+                     mov  eax, 0x006FB550; // reproduce patched-over call
+                     call eax;             //
+                     push eax; // protect
+                     call Inner; // stdcall
+                     pop  eax; // restore
+                     test al, al; // reproduce patched-over instruction
+                     mov  edx, 0x0070CE9B;
+                     jmp  edx;
+                  }
+               }
+               void Apply() {
+                  WriteRelJump(0x0070CE94, (UInt32)&Outer); // in the vampire-feed procedure's idle completion check
+                  SafeWrite16 (0x0070CE94 + 5, 0x9090); // NOP
+               }
+            }
+            void Apply() {
+               ProcedureHook::Apply();
+               PlayerAIDriven::Watch(&Check);
+            }
+         }
+
          namespace Exact {
             //
             // This hook patches the specific piece of code that ends up causing  
@@ -69,17 +175,6 @@ namespace CobbBugFixes {
             // bedroll. The save had a high, but not 100%, rate of softlocking when 
             // feeding on him in this position.)
             //
-            bool UsesPackage(RE::Actor* actor, RE::TESPackage* package) {
-               auto pm = actor->processManager;
-               if (pm) {
-                  if (pm->unk0C.unk00 == package)
-                     return true;
-                  auto middle = pm->middleProcess;
-                  if (middle && middle->unk30.unk00 == package)
-                     return true;
-               }
-               return false;
-            }
             void _stdcall Inner(RE::TESPackage* package) {
                //
                // We patch before the TESPackage destructor is actually called, so 
@@ -92,9 +187,10 @@ namespace CobbBugFixes {
                   if (!player)
                      return;
                   bool isDriven = player->unk726 & 8;
-                  if (isDriven && UsesPackage(player, package)) {
+                  if (isDriven && PlayerAIDriven::HasPackage(player, package)) {
                      //_MESSAGE(" - Player is AI-driven and this package belongs to them. Cleaning up.");
                      CALL_MEMBER_FN(player, SetPlayerAIDriven)(false);
+                     Watchdog::Disarm();
                      //_MESSAGE("    - Done.");
                   }
                }
@@ -143,6 +239,7 @@ namespace CobbBugFixes {
                   bool isDriven = player->unk726 & 8; // There's no getter we can call, to my knowledge, but this is the flag the game uses.
                   if (isDriven) {
                      CALL_MEMBER_FN(player, SetPlayerAIDriven)(false); // The game does other stuff besides just setting the flag, so use the setter.
+                     Watchdog::Disarm();
                   }
                }
             }
@@ -164,6 +261,7 @@ namespace CobbBugFixes {
          }
          //
          void Apply() {
+            Watchdog::Apply();
             Exact::Apply();
          }
       }
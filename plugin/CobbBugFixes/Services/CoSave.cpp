@@ -0,0 +1,88 @@
+#include "CoSave.h"
+#include <algorithm> // std::min
+
+namespace CobbBugFixes {
+   namespace CoSave {
+      bool RecordReader::Read(void* out, UInt32 size) {
+         if (this->failed)
+            return false;
+         if (size > this->remaining) {
+            this->failed = true;
+            return false;
+         }
+         UInt32 read = this->intfc->ReadRecordData(out, size);
+         this->remaining -= (std::min)(read, this->remaining);
+         if (read != size) {
+            this->failed = true;
+            return false;
+         }
+         return true;
+      }
+      void RecordReader::SkipToEnd() {
+         UInt8 scratch[256];
+         while (this->remaining) {
+            UInt32 size = (std::min)(this->remaining, (UInt32)sizeof(scratch));
+            UInt32 read = this->intfc->ReadRecordData(scratch, size);
+            if (!read) // SKSE has nothing more to give us
+               break;
+            this->remaining -= (std::min)(read, this->remaining);
+         }
+      }
+
+      RecordCodec::RecordCodec(const char* n, UInt32 s, UInt32 v, save_t sv, load_t ld, migrate_t mg) : name(n), signature(s), version(v), save(sv), load(ld), migrate(mg) {
+         Manager::GetInstance().Add(this);
+      }
+
+      Manager& Manager::GetInstance() {
+         static Manager instance;
+         return instance;
+      }
+      void Manager::Add(RecordCodec* codec) {
+         this->codecs.push_back(codec);
+      }
+      RecordCodec* Manager::Get(UInt32 signature) const {
+         for (auto codec : this->codecs)
+            if (codec->signature == signature)
+               return codec;
+         return nullptr;
+      }
+      void Manager::Save(SKSESerializationInterface* intfc) {
+         for (auto codec : this->codecs) {
+            if (codec->save(intfc))
+               _MESSAGE("Saving complete (or no data to save) for the %s.", codec->name);
+            else
+               _MESSAGE("Saving failed for the %s.", codec->name);
+         }
+      }
+      bool Manager::Load(SKSESerializationInterface* intfc, UInt32 signature, UInt32 version, UInt32 length) {
+         RecordReader reader(intfc, length);
+         auto codec = this->Get(signature);
+         if (!codec) {
+            _MESSAGE("Skipping unrecognized record %08X (version %u, %u bytes).", signature, version, length);
+            reader.SkipToEnd();
+            return true;
+         }
+         bool success;
+         if (version == codec->version) {
+            success = codec->load(reader);
+         } else if (version < codec->version && codec->migrate) {
+            _MESSAGE("Migrating the %s's data from record version %u to version %u.", codec->name, version, codec->version);
+            success = codec->migrate(reader, version);
+         } else {
+            _MESSAGE("Skipping the %s's data: record version %u isn't supported (current version is %u).", codec->name, version, codec->version);
+            reader.SkipToEnd();
+            return true;
+         }
+         success = success && !reader.Failed();
+         if (success) {
+            if (reader.Remaining())
+               _MESSAGE("Loading complete for the %s; ignoring %u unread bytes at the end of its record.", codec->name, reader.Remaining());
+            else
+               _MESSAGE("Loading complete for the %s.", codec->name);
+         } else
+            _MESSAGE("Loading failed for the %s; skipping the rest of its record.", codec->name);
+         reader.SkipToEnd();
+         return success;
+      }
+   }
+}
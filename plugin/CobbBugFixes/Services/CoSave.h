@@ -0,0 +1,143 @@
+#pragma once
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "skse/PluginAPI.h"
+
+namespace CobbBugFixes {
+   namespace CoSave {
+      //
+      // A bounded cursor over the record currently being loaded. It tracks how many bytes of 
+      // the record are left and refuses reads that would run past the end, so a truncated or 
+      // corrupt record can't cause us to misinterpret whatever follows it. Once a read fails, 
+      // all further reads fail as well; callers can check the result of each read or just 
+      // check Failed() at the end.
+      //
+      class RecordReader {
+         private:
+            SKSESerializationInterface* const intfc;
+            UInt32 remaining;
+            bool   failed = false;
+            //
+         public:
+            RecordReader(SKSESerializationInterface* i, UInt32 length) : intfc(i), remaining(length) {}
+            //
+            SKSESerializationInterface* Interface() const { return this->intfc; }
+            UInt32 Remaining() const { return this->remaining; }
+            bool   Failed() const { return this->failed; }
+            //
+            bool Read(void* out, UInt32 size);
+            void SkipToEnd(); // discards whatever is left of the record
+            //
+            template<typename T> bool Read(T& out) {
+               static_assert(std::is_trivially_copyable_v<T>, "Only fixed-layout types can be read directly.");
+               return this->Read(&out, sizeof(T));
+            }
+            //
+            // Reads an array written by WriteArray. Fails without allocating if the stored 
+            // count would run past the end of the record.
+            //
+            template<typename T> bool ReadArray(std::vector<T>& out) {
+               static_assert(std::is_trivially_copyable_v<T>, "Only fixed-layout types can be read in bulk.");
+               UInt32 count = 0;
+               if (!this->Read(count))
+                  return false;
+               if (count > this->remaining / sizeof(T)) {
+                  this->failed = true;
+                  return false;
+               }
+               out.resize(count);
+               if (!count)
+                  return true;
+               return this->Read(out.data(), sizeof(T) * count);
+            }
+      };
+
+      //
+      // Each patch that persists state defines one static RecordCodec per record type. Like 
+      // INISettings, codecs register themselves with the manager when they're constructed, 
+      // so main.cpp doesn't need to know about individual record types.
+      //
+      // Saving: the codec's save callback opens its own record (so that it can skip writing 
+      // anything when there's no data) and should use WriteArray for fixed-layout data.
+      //
+      // Loading: records whose version matches the codec's current version are handed to 
+      // the load callback. Records from older versions are handed to the migrate callback, 
+      // if there is one, and skipped otherwise. Records from newer versions, and records 
+      // that no codec claims, are skipped. Whatever a callback leaves unread is skipped as 
+      // well, and a failed record doesn't stop us from loading the ones after it.
+      //
+      struct RecordCodec {
+         using save_t    = bool(*)(SKSESerializationInterface*);
+         using load_t    = bool(*)(RecordReader&);
+         using migrate_t = bool(*)(RecordReader&, UInt32 version);
+         //
+         RecordCodec(const char* n, UInt32 s, UInt32 v, save_t sv, load_t ld, migrate_t mg = nullptr);
+         //
+         const char* const name; // for logging
+         const UInt32    signature;
+         const UInt32    version; // written with each record; records with this version go to (load)
+         const save_t    save;
+         const load_t    load;
+         const migrate_t migrate;
+      };
+
+      class Manager {
+         private:
+            std::vector<RecordCodec*> codecs;
+         public:
+            static Manager& GetInstance();
+            //
+            void Add(RecordCodec*);
+            RecordCodec* Get(UInt32 signature) const;
+            //
+            void Save(SKSESerializationInterface*);
+            bool Load(SKSESerializationInterface*, UInt32 signature, UInt32 version, UInt32 length); // returns false if the record was claimed but couldn't be read
+      };
+
+      //
+      // Fixed-layout arrays are written as a UInt32 count followed by the elements, using one
+      // interface call for each rather than one per element. The count is always 32 bits 
+      // wide, regardless of the width of size_t.
+      //
+      template<typename T> bool WriteArray(SKSESerializationInterface* intfc, const T* data, UInt32 count) {
+         static_assert(std::is_trivially_copyable_v<T>, "Only fixed-layout types can be written in bulk.");
+         if (!intfc->WriteRecordData(&count, sizeof(count)))
+            return false;
+         if (!count)
+            return true;
+         return intfc->WriteRecordData(data, sizeof(T) * count);
+      }
+      template<typename T> bool WriteArray(SKSESerializationInterface* intfc, const std::vector<T>& data) {
+         return WriteArray(intfc, data.data(), (UInt32)data.size());
+      }
+      //
+      // Resolves the form IDs stored in (records) after a load, in one pass. SKSE resolves a 
+      // form ID by remapping its load order index, so we sort the records by mod index and 
+      // ask SKSE about each distinct mod index once, instead of once per record. Records 
+      // whose mod is no longer loaded get a form ID of zero. Note that this reorders the 
+      // records. Returns the number of records that could not be resolved.
+      //
+      template<typename T> UInt32 ResolveFormIDs(SKSESerializationInterface* intfc, std::vector<T>& records, UInt32 T::* field) {
+         std::sort(records.begin(), records.end(), [field](const T& a, const T& b) { return (a.*field >> 24) < (b.*field >> 24); });
+         UInt32 unresolved = 0;
+         size_t size = records.size();
+         size_t i    = 0;
+         while (i < size) {
+            UInt32 modIndex = records[i].*field >> 24;
+            UInt32 resolved = 0;
+            bool   success  = intfc->ResolveFormId(modIndex << 24, &resolved);
+            for (; i < size && (records[i].*field >> 24) == modIndex; ++i) {
+               UInt32& id = records[i].*field;
+               if (success) {
+                  id = (resolved & 0xFF000000) | (id & 0x00FFFFFF);
+               } else {
+                  id = 0;
+                  ++unresolved;
+               }
+            }
+         }
+         return unresolved;
+      }
+   }
+}
@@ -1,6 +1,7 @@
 #include "CrashLog.h"
 #include "CrashLogDefinitions.h"
 #include "Patches/DetectShutdown.h"
+#include "Patches/PlayerAIDrivenRecovery.h"
 #include <algorithm> // std::min
 #include <cstdint>
 #include <psapi.h>  // MODULEINFO, GetModuleInformation
@@ -309,6 +310,7 @@ void _logCrash(EXCEPTION_POINTERS* info) {
          _MESSAGE("UNABLE TO EXAMINE LOADED DLLs.");
       }
    }
+   CobbBugFixes::Patches::PlayerAIDrivenRecovery::LogHistory();
    _MESSAGE("\nALL DATA PRINTED.");
 }
 LONG WINAPI _filter(EXCEPTION_POINTERS* info) {
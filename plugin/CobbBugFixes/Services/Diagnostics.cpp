@@ -0,0 +1,38 @@
+#include "Diagnostics.h"
+#include "ReverseEngineered/Systems/012E32E8.h" // g_globalActorTimer
+#include <cstring>
+
+namespace CobbBugFixes {
+   namespace Diagnostics {
+      DWORD _now() {
+         DWORD now = GetTickCount();
+         return now ? now : 1; // zero means "not started"
+      }
+
+      void ReportGate::Start() {
+         this->last = _now();
+      }
+      bool ReportGate::Due(DWORD* elapsed) {
+         DWORD now  = _now();
+         DWORD last = this->last;
+         if (!last) {
+            this->last.compare_exchange_strong(last, now);
+            return false;
+         }
+         if (now - last < this->interval)
+            return false;
+         if (!this->last.compare_exchange_strong(last, now)) // another thread got here first
+            return false;
+         if (elapsed)
+            *elapsed = now - last;
+         return true;
+      }
+
+      bool FrameDetector::NewFrame() {
+         float  now = *RE::g_globalActorTimer;
+         UInt32 bits;
+         memcpy(&bits, &now, sizeof(bits));
+         return this->bits.exchange(bits) != bits;
+      }
+   }
+}
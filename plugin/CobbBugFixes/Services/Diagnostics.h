@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+
+namespace CobbBugFixes {
+   namespace Diagnostics {
+      //
+      // Building blocks for the optional statistics that some patches write to the log:
+      // counters that are drained whenever a report is written, a gate that decides when
+      // a report is due, per-frame series, and a way for hooks to tell frames apart.
+      //
+
+      //
+      // A count that any thread can add to. Take() returns the count and resets it.
+      //
+      class Counter {
+         private:
+            std::atomic<UInt32> value;
+         public:
+            Counter() : value(0) {}
+            //
+            void   operator++() { ++this->value; }
+            void   Add(UInt32 n) { this->value += n; }
+            UInt32 Take() { return this->value.exchange(0); }
+      };
+
+      //
+      // Decides when a periodic report is due. Due() returns true at most once per interval,
+      // to whichever thread first notices that the interval has passed. The interval starts
+      // when Start() is called or, failing that, on the first call to Due(); either way, the
+      // first report covers a full interval.
+      //
+      class ReportGate {
+         private:
+            const DWORD interval; // milliseconds
+            std::atomic<DWORD> last; // GetTickCount as of the last report, or zero if we haven't started
+         public:
+            explicit ReportGate(DWORD ms) : interval(ms), last(0) {}
+            //
+            void Start();
+            bool Due(DWORD* elapsed = nullptr); // on success, (elapsed) receives the milliseconds since the last report
+      };
+
+      //
+      // Per-frame values: the number of frames, their total, and the peak. Not thread-safe;
+      // it should only be touched by whichever thread closes out frames.
+      //
+      template<typename T> struct FrameSeries {
+         UInt32 frames = 0;
+         T      total  = 0;
+         T      peak   = 0;
+         //
+         void Add(T value) {
+            ++this->frames;
+            this->total += value;
+            if (value > this->peak)
+               this->peak = value;
+         }
+         double Average() const {
+            return this->frames ? (double)this->total / this->frames : 0.0;
+         }
+         void Reset() {
+            *this = FrameSeries();
+         }
+      };
+
+      //
+      // Lets hooks that may run on several threads tell frames apart, by watching the global
+      // actor timer (which advances once per frame). For each new frame, exactly one caller
+      // of NewFrame() gets true, and that caller should close out the previous frame.
+      //
+      class FrameDetector {
+         private:
+            std::atomic<UInt32> bits; // bit pattern of the actor timer for the current frame
+         public:
+            FrameDetector() : bits(0) {}
+            //
+            bool NewFrame();
+      };
+   }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace CobbBugFixes {
+   //
+   // A sorted formID -> form map for a single form type, built from one of DataHandler's
+   // typed form arrays. Lookups are a binary search, and since every form in the source
+   // array is already of the right type, callers don't need to DYNAMIC_CAST the result.
+   //
+   // The index holds raw pointers, so only build it from forms that live for the whole
+   // session (i.e. forms loaded from plugins, after DataLoaded).
+   //
+   template<typename T> class FormIndex {
+      private:
+         using entry_t = std::pair<UInt32, T*>;
+         std::vector<entry_t> entries;
+         //
+      public:
+         void Build(T* const* forms, UInt32 count) {
+            this->entries.clear();
+            this->entries.reserve(count);
+            for (UInt32 i = 0; i < count; i++)
+               if (auto form = forms[i])
+                  this->entries.emplace_back(form->formID, form);
+            std::sort(this->entries.begin(), this->entries.end(), [](const entry_t& a, const entry_t& b) { return a.first < b.first; });
+         }
+         void Clear() {
+            this->entries.clear();
+            this->entries.shrink_to_fit();
+         }
+         bool  IsBuilt() const { return !this->entries.empty(); }
+         T*    Lookup(UInt32 formID) const {
+            auto it = std::lower_bound(this->entries.begin(), this->entries.end(), formID, [](const entry_t& a, UInt32 b) { return a.first < b; });
+            if (it != this->entries.end() && it->first == formID)
+               return it->second;
+            return nullptr;
+         }
+         size_t size() const { return this->entries.size(); }
+   };
+}
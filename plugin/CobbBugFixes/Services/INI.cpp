@@ -13,16 +13,27 @@ namespace CobbBugFixes {
       #define COBBBUGFIXES_MAKE_INI_SETTING(category, name, value) namespace category { extern INISetting name = INISetting(#name, #category, value); };
       //
       COBBBUGFIXES_MAKE_INI_SETTING(ActiveEffectTimerFixes, Enabled, true);
+      COBBBUGFIXES_MAKE_INI_SETTING(ActiveEffectTimerFixes, LogConditionUpdateStats, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(ArcheryDownwardArrowFix, LogRaycastStats, false);
       COBBBUGFIXES_MAKE_INI_SETTING(CrashLogging, Enabled, false);
       COBBBUGFIXES_MAKE_INI_SETTING(CrashLogging, StackCount, UInt32(40));
       COBBBUGFIXES_MAKE_INI_SETTING(MerchantRestockFixes, Enabled, true);
       COBBBUGFIXES_MAKE_INI_SETTING(ModArmorWeightPerk, FixInitial, true);
       COBBBUGFIXES_MAKE_INI_SETTING(ModArmorWeightPerk, FixStacks, true);
+      COBBBUGFIXES_MAKE_INI_SETTING(ModelLoadBenchmark, Enabled, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(ModelLoadBenchmark, Iterations, UInt32(5));
       COBBBUGFIXES_MAKE_INI_SETTING(NPCTorchLandscapeFix, Enabled, true);
+      COBBBUGFIXES_MAKE_INI_SETTING(NPCTorchLandscapeFix, AuditLighting, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(PackageTracer, Enabled, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(PlayerAIDrivenRecovery, ConsoleCommand, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(PlayerAIDrivenRecovery, Enabled, false);
+      COBBBUGFIXES_MAKE_INI_SETTING(PlayerAIDrivenRecovery, StuckSeconds, UInt32(10));
       COBBBUGFIXES_MAKE_INI_SETTING(TrainerFixes, FixCostUI, true);
       COBBBUGFIXES_MAKE_INI_SETTING(UnderwaterAmbienceCellBoundaryFix, Enabled, true);
+      COBBBUGFIXES_MAKE_INI_SETTING(UnderwaterAmbienceCellBoundaryFix, LogCacheStats, false);
       //
       COBBBUGFIXES_MAKE_INI_SETTING(CrashFixes, TESIdleFormDestructor, true);
+      COBBBUGFIXES_MAKE_INI_SETTING(CrashFixes, FastExit, false);
       //
       #undef COBBBUGFIXES_MAKE_INI_SETTING
       //
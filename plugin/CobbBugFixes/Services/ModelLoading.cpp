@@ -0,0 +1,17 @@
+#include "ModelLoading.h"
+#include "ReverseEngineered\Shared.h"
+
+namespace CobbBugFixes {
+   namespace ModelLoading {
+      DEFINE_SUBROUTINE(UInt32, Subroutine00AF5820_MaybeLoadModel, 0x00AF5820, const char* path, NiPointer<NiNode>& out, LoadModelOptions& options);
+      // another subroutine with the same signature seems to be used for load screens: 0x00AF5680
+
+      UInt32 LoadModel(const char* path, NiPointer<NiNode>& out) {
+         LoadModelOptions options;
+         return Subroutine00AF5820_MaybeLoadModel(path, out, options);
+      }
+      UInt32 LoadModel(const char* path, NiPointer<NiNode>& out, LoadModelOptions& options) {
+         return Subroutine00AF5820_MaybeLoadModel(path, out, options);
+      }
+   }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "skse/NiTypes.h"
+
+class NiNode;
+
+namespace CobbBugFixes {
+   namespace ModelLoading {
+      struct LoadModelOptions {
+         UInt32 unk00 = 3;
+         UInt32 unk04 = 3;
+         bool   unk08 = false;
+         bool   unk09 = false; // "is facegen head?" "is helmet?"
+         bool   unk0A = true;
+         bool   unk0B = true;
+      };
+      //
+      // Loads a model (path relative to the Meshes folder) through the game's model 
+      // database, with default options. Returns zero on success.
+      //
+      // Only call this on the main thread. The game's own background loading runs on threads 
+      // that it has set up itself, and we haven't verified that the loader is safe to call 
+      // from anywhere else.
+      //
+      UInt32 LoadModel(const char* path, NiPointer<NiNode>& out);
+      UInt32 LoadModel(const char* path, NiPointer<NiNode>& out, LoadModelOptions& options);
+   }
+}
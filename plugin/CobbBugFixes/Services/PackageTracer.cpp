@@ -0,0 +1,137 @@
+#include "PackageTracer.h"
+#include "ReverseEngineered/Forms/Actor.h"
+#include "ReverseEngineered/Forms/TESPackage.h"
+#include "ReverseEngineered/Systems/012E32E8.h" // g_globalActorTimer
+#include "ReverseEngineered/Systems/BSTEvent.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "INI.h"
+
+namespace CobbBugFixes {
+   namespace PackageTracer {
+      //
+      // Package events can be sent from the AI worker threads as well as the main thread, but
+      // BSTEventSource holds its own lock while it dispatches an event to its sinks, so our
+      // Handle method never runs on two threads at once. Everything below is only touched from
+      // inside Handle -- including the report, which runs inline once enough actor time has
+      // passed -- so none of it needs atomics or a lock of its own.
+      //
+      constexpr float  ce_reportInterval = 10.0F; // seconds of actor time
+      constexpr UInt32 ce_reportCount    = 10;    // number of actors to list
+      //
+      // TESPackageEvent::eventType values. The engine's order is start, change, end, but the
+      // RE headers (skyrim-classic-re, which isn't vendored here; see ReverseEngineered's
+      // README) only name the first. TODO: add kType_PackageChange next to kType_PackageStart
+      // there, and use it in place of this constant; until then, this is the one place that
+      // relies on the order.
+      //
+      constexpr UInt32 ce_packageStart  = RE::TESPackageEvent::kType_PackageStart;
+      constexpr UInt32 ce_packageChange = ce_packageStart + 1; // kType_PackageChange
+
+      struct _Current {
+         UInt32 package = 0;
+         float  since   = 0.0F;
+      };
+      struct _ActorStats {
+         UInt32 actor    = 0;
+         UInt32 events   = 0;
+         UInt32 changes  = 0; // start/change events, i.e. package switches
+         float  spent    = 0.0F;
+         UInt32 spentCount = 0;
+         UInt32 lastPackage = 0;
+         UInt8  lastType    = 0;
+      };
+      static std::unordered_map<UInt32, _Current>    s_current; // actor form ID -> the package it's running
+      static std::unordered_map<UInt32, _ActorStats> s_window;  // actor form ID -> its events since the last report
+      static UInt32 s_total      = 0;
+      static float  s_lastReport = 0.0F;
+
+      void _record(bool isEnd, UInt32 actor, UInt32 package, UInt8 packageType, float spent) {
+         auto& stats = s_window[actor];
+         stats.actor = actor;
+         ++stats.events;
+         if (!isEnd)
+            ++stats.changes;
+         if (spent >= 0.0F) {
+            stats.spent += spent;
+            ++stats.spentCount;
+         }
+         stats.lastPackage = package;
+         stats.lastType    = packageType;
+         ++s_total;
+      }
+      void _report(float now) {
+         float window = now - s_lastReport;
+         if (s_total && window > 0.0F) {
+            std::vector<_ActorStats> sorted;
+            sorted.reserve(s_window.size());
+            for (auto& pair : s_window)
+               sorted.push_back(pair.second);
+            std::sort(sorted.begin(), sorted.end(), [](const _ActorStats& a, const _ActorStats& b) { return a.changes > b.changes; });
+            _MESSAGE("Package churn over the last %.1f seconds: %u package events across %u actors (%.1f per second).", window, s_total, (UInt32)sorted.size(), s_total / window);
+            UInt32 count = (std::min)((UInt32)sorted.size(), ce_reportCount);
+            for (UInt32 i = 0; i < count; ++i) {
+               auto& s = sorted[i];
+               float average = s.spentCount ? s.spent / s.spentCount : 0.0F;
+               _MESSAGE(" - Actor %08X: %.2f package switches per second; %.2f seconds per package on average; most recently package %08X (type %u).", s.actor, s.changes / window, average, s.lastPackage, s.lastType);
+            }
+         }
+         s_window.clear();
+         s_total      = 0;
+         s_lastReport = now;
+      }
+
+      struct Listener : RE::BSTEventSink<RE::TESPackageEvent> {
+         virtual EventResult Handle(void* aEv, void* aSource) override {
+            auto ev = convertEvent(aEv);
+            if (!ev || !ev->target)
+               return EventResult::kEvent_Continue;
+            float  now     = *RE::g_globalActorTimer;
+            UInt32 actorID = ((RE::Actor*)ev->target)->formID;
+            UInt8  type    = 0;
+            if (ev->packageFormID)
+               if (auto package = (RE::TESPackage*)LookupFormByID(ev->packageFormID))
+                  type = package->type;
+            //
+            if (now < s_lastReport) { // the actor timer was reset, e.g. by loading a save
+               s_current.clear();
+               s_window.clear();
+               s_total      = 0;
+               s_lastReport = now;
+            }
+            bool  isEnd = ev->eventType != ce_packageStart && ev->eventType != ce_packageChange;
+            float spent = -1.0F;
+            {
+               auto& current = s_current[actorID];
+               if (current.package && now >= current.since)
+                  spent = now - current.since;
+               if (isEnd) {
+                  s_current.erase(actorID);
+               } else {
+                  current.package = ev->packageFormID;
+                  current.since   = now;
+               }
+            }
+            _record(isEnd, actorID, ev->packageFormID, type, spent);
+            //
+            if (now - s_lastReport >= ce_reportInterval)
+               _report(now);
+            return EventResult::kEvent_Continue;
+         };
+         static Listener* GetInstance() {
+            static Listener instance;
+            return &instance;
+         };
+      };
+
+      void OnDataLoaded() {
+         if (INI::PackageTracer::Enabled.bCurrent == false)
+            return;
+         auto holder = RE::BSTEventSourceHolder::GetOrCreate();
+         CALL_MEMBER_FN(&holder->package, AddEventSink)(Listener::GetInstance());
+         _MESSAGE("Package tracing is enabled; reports will be written every %.0f seconds of actor time.", ce_reportInterval);
+      }
+   }
+}
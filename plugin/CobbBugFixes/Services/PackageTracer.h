@@ -0,0 +1,13 @@
+#pragma once
+
+namespace CobbBugFixes {
+   namespace PackageTracer {
+      //
+      // Records AI package start, change, and end events for every actor, and periodically
+      // writes a "package churn" report to the log: which actors are switching packages the
+      // most often, and what they're switching between. This is meant for diagnosing stutter
+      // in load orders where AI packages are thrashing. Disabled unless enabled in the INI.
+      //
+      void OnDataLoaded(); // registers our event sink
+   }
+}
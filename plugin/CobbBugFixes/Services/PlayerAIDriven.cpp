@@ -0,0 +1,104 @@
+#include "PlayerAIDriven.h"
+#include "ReverseEngineered/Player/PlayerCharacter.h"
+#include "skse/GameThreads.h" // TaskDelegate
+#include <atomic>
+#include <vector>
+
+namespace CobbBugFixes {
+   namespace PlayerAIDriven {
+      static std::vector<check_t> s_checks; // only modified before the thread starts
+      static SKSETaskInterface*   s_tasks   = nullptr;
+      static HANDLE               s_stop    = nullptr;
+      static HANDLE               s_thread  = nullptr;
+      static std::atomic<bool>    s_pending(false); // is a CheckTask waiting to run?
+
+      bool IsAIDriven() {
+         auto player = *RE::g_thePlayer;
+         return player && (player->unk726 & 8);
+      }
+      RE::TESPackage* GetPackage(RE::Actor* actor) {
+         auto pm = actor->processManager;
+         if (!pm)
+            return nullptr;
+         if (auto package = pm->unk0C.unk00)
+            return package;
+         auto middle = pm->middleProcess;
+         if (middle)
+            return middle->unk30.unk00;
+         return nullptr;
+      }
+      bool HasPackage(RE::Actor* actor, RE::TESPackage* package) {
+         auto pm = actor->processManager;
+         if (!pm)
+            return false;
+         if (pm->unk0C.unk00 == package)
+            return true;
+         auto middle = pm->middleProcess;
+         return middle && middle->unk30.unk00 == package;
+      }
+      bool HasPackageOfType(RE::Actor* actor, UInt8 type) {
+         auto pm = actor->processManager;
+         if (!pm)
+            return false;
+         auto package = pm->unk0C.unk00;
+         if (package && package->type == type)
+            return true;
+         auto middle = pm->middleProcess;
+         if (!middle)
+            return false;
+         package = middle->unk30.unk00;
+         return package && package->type == type;
+      }
+      void Release() {
+         auto player = *RE::g_thePlayer;
+         if (player)
+            CALL_MEMBER_FN(player, SetPlayerAIDriven)(false); // the game does other stuff besides just clearing the flag, so use the setter
+      }
+
+      class CheckTask : public TaskDelegate {
+         public:
+            virtual void Run() override {
+               s_pending = false;
+               bool driven = IsAIDriven();
+               for (auto check : s_checks)
+                  check(driven);
+            }
+            virtual void Dispose() override {
+               delete this;
+            }
+      };
+      DWORD WINAPI _threadMain(LPVOID) {
+         bool wasDriven = false;
+         while (WaitForSingleObject(s_stop, ce_pollInterval) == WAIT_TIMEOUT) {
+            bool driven = IsAIDriven();
+            if ((driven || wasDriven) && !s_pending.exchange(true))
+               s_tasks->AddTask(new CheckTask);
+            wasDriven = driven;
+         }
+         return 0;
+      }
+
+      void Watch(check_t check) {
+         s_checks.push_back(check);
+      }
+      void Start(SKSETaskInterface* tasks) {
+         if (s_checks.empty() || s_thread)
+            return;
+         if (!tasks) {
+            _MESSAGE("The SKSE task interface isn't available, so checks on the player's AI-driven state are disabled.");
+            return;
+         }
+         s_tasks  = tasks;
+         s_stop   = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+         s_thread = CreateThread(nullptr, 0, _threadMain, nullptr, 0, nullptr);
+      }
+      void Stop() {
+         if (!s_thread)
+            return;
+         SetEvent(s_stop);
+         WaitForSingleObject(s_thread, ce_pollInterval * 2);
+         CloseHandle(s_thread);
+         s_thread = nullptr;
+      }
+   }
+}
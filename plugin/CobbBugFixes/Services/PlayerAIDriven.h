@@ -0,0 +1,39 @@
+#pragma once
+#include "skse/PluginAPI.h"
+#include "ReverseEngineered/Forms/Actor.h"
+#include "ReverseEngineered/Forms/TESPackage.h"
+
+namespace CobbBugFixes {
+   namespace PlayerAIDriven {
+      //
+      // Shared support for patches that deal with the player's "AI-driven" state (flag 0x08 on
+      // PlayerCharacter::unk726), in which the game drives the player with an AI package as it
+      // would an NPC, and the player can't move or turn.
+      //
+      // A single background thread polls the AI-driven flag, and nothing else, twice a second.
+      // Whenever the player is AI-driven, or has just stopped being AI-driven, it queues a task
+      // that runs the registered checks on the main thread; only there is it safe to look at the
+      // player's process manager and packages, which AI processing can change or free at any
+      // time.
+      //
+      // Because this is polling, a spell of AI-driven state (or a break in one) that's shorter
+      // than the poll interval can go unseen.
+      //
+      constexpr DWORD ce_pollInterval = 500; // milliseconds
+      //
+      typedef void(*check_t)(bool driven); // runs on the main thread
+
+      bool IsAIDriven(); // safe to call from any thread
+      //
+      // Main thread only:
+      //
+      RE::TESPackage* GetPackage(RE::Actor*); // the first package in the process manager's or middle process's package slot
+      bool HasPackage(RE::Actor*, RE::TESPackage*);
+      bool HasPackageOfType(RE::Actor*, UInt8 type);
+      void Release(); // calls SetPlayerAIDriven(false)
+      //
+      void Watch(check_t); // call before Start
+      void Start(SKSETaskInterface*); // starts the polling thread if anything is being watched
+      void Stop(); // lets the polling thread exit; called when the game shuts down
+   }
+}
@@ -0,0 +1,114 @@
+#include "Trace.h"
+#include <cstring>
+#include <mutex>
+#include <shlobj.h> // SHGetFolderPath
+#include <string>
+
+namespace CobbBugFixes {
+   namespace Trace {
+      constexpr UInt32 ce_capacity = 0x40000; // 256K records * 64 bytes == 16MB
+
+      static HANDLE                   s_file    = INVALID_HANDLE_VALUE;
+      static HANDLE                   s_mapping = nullptr;
+      static TraceFormat::FileHeader* s_header  = nullptr;
+      static Record*                  s_records = nullptr;
+      static std::once_flag           s_opened;
+
+      bool _getPath(std::string& out) {
+         char path[MAX_PATH];
+         if (FAILED(SHGetFolderPath(NULL, CSIDL_MYDOCUMENTS | CSIDL_FLAG_CREATE, NULL, SHGFP_TYPE_CURRENT, path)))
+            return false;
+         out = path;
+         out += "\\My Games\\Skyrim\\SKSE\\CobbBugFixes.trace";
+         return true;
+      }
+      void _open() {
+         std::string path;
+         if (!_getPath(path)) {
+            _MESSAGE("Trace: unable to locate the My Documents folder; tracing is disabled.");
+            return;
+         }
+         constexpr UInt32 size = sizeof(TraceFormat::FileHeader) + sizeof(Record) * ce_capacity;
+         s_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+         if (s_file == INVALID_HANDLE_VALUE) {
+            _MESSAGE("Trace: unable to create %s (error %u); tracing is disabled.", path.c_str(), GetLastError());
+            return;
+         }
+         s_mapping = CreateFileMappingA(s_file, NULL, PAGE_READWRITE, 0, size, NULL);
+         if (!s_mapping) {
+            _MESSAGE("Trace: unable to map the trace file (error %u); tracing is disabled.", GetLastError());
+            Close();
+            return;
+         }
+         auto view = (UInt8*) MapViewOfFile(s_mapping, FILE_MAP_WRITE, 0, 0, size);
+         if (!view) {
+            _MESSAGE("Trace: unable to view the trace file (error %u); tracing is disabled.", GetLastError());
+            Close();
+            return;
+         }
+         //
+         // A freshly-created mapping is zero-filled, so every record starts out with sequence
+         // number zero, i.e. "never written."
+         //
+         auto header = (TraceFormat::FileHeader*) view;
+         header->magic      = TraceFormat::ce_magic;
+         header->version    = TraceFormat::ce_version;
+         header->recordSize = sizeof(Record);
+         header->capacity   = ce_capacity;
+         {
+            LARGE_INTEGER li;
+            QueryPerformanceFrequency(&li);
+            header->timerFrequency = li.QuadPart;
+            QueryPerformanceCounter(&li);
+            header->timerStart = li.QuadPart;
+         }
+         header->cursor = 0;
+         s_records = (Record*)(view + sizeof(TraceFormat::FileHeader));
+         s_header  = header;
+         _MESSAGE("Trace: writing binary trace to %s.", path.c_str());
+      }
+
+      void Entry::WriteString(UInt32 firstField, const char* str) {
+         if (!this->record || !str || firstField >= TraceFormat::ce_fieldCount)
+            return;
+         auto   dst = this->record->data.s + firstField * 4;
+         size_t max = (TraceFormat::ce_fieldCount - firstField) * 4 - 1; // leave room for a terminator
+         strncpy_s(dst, max + 1, str, _TRUNCATE);
+      }
+
+      Entry Begin(Event e) {
+         std::call_once(s_opened, &_open);
+         auto header = s_header;
+         if (!header)
+            return Entry();
+         UInt32 sequence = InterlockedIncrement((volatile LONG*)&header->cursor);
+         if (!sequence) // the cursor wrapped around; zero is reserved for "not written"
+            sequence = InterlockedIncrement((volatile LONG*)&header->cursor);
+         auto record = &s_records[(sequence - 1) % ce_capacity];
+         record->sequence = 0; // mark as in-progress until the Entry publishes it
+         LARGE_INTEGER li;
+         QueryPerformanceCounter(&li);
+         record->timestamp = li.QuadPart;
+         record->event     = (UInt16)e;
+         record->thread    = (UInt16)GetCurrentThreadId();
+         memset(&record->data, 0, sizeof(record->data));
+         return Entry(record, sequence);
+      }
+      void Close() {
+         if (s_header) {
+            FlushViewOfFile(s_header, 0);
+            UnmapViewOfFile(s_header);
+            s_header  = nullptr;
+            s_records = nullptr;
+         }
+         if (s_mapping) {
+            CloseHandle(s_mapping);
+            s_mapping = nullptr;
+         }
+         if (s_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(s_file);
+            s_file = INVALID_HANDLE_VALUE;
+         }
+      }
+   }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "TraceFormat.h"
+
+namespace CobbBugFixes {
+   namespace Trace {
+      //
+      // Typed binary event tracer for exploratory patches. Records are written into a memory-
+      // mapped ring file (My Games\Skyrim\SKSE\CobbBugFixes.trace) instead of being formatted
+      // as text, so hooks on hot game-thread paths can log for hours without hitching. Because
+      // the file is memory-mapped, records written before a crash still reach the disk. Use
+      // the decoder in tools/TraceDecoder to turn the file into text or CSV.
+      //
+      // Usage:
+      //
+      //    if (auto entry = Trace::Begin(Trace::Event::some_event)) {
+      //       entry->data.u[0] = form->formID;
+      //       entry->data.f[1] = pos.x;
+      //    } // the record is published when the entry goes out of scope
+      //
+      // The trace file is opened on first use. If it can't be opened, Begin returns an empty
+      // entry and tracing is silently disabled for the rest of the session.
+      //
+      using Event  = TraceFormat::Event;
+      using Record = TraceFormat::Record;
+
+      class Entry {
+         private:
+            Record* record   = nullptr;
+            UInt32  sequence = 0;
+         public:
+            Entry() {}
+            Entry(Record* r, UInt32 s) : record(r), sequence(s) {}
+            Entry(const Entry&) = delete;
+            Entry(Entry&& other) : record(other.record), sequence(other.sequence) { other.record = nullptr; }
+            ~Entry() {
+               if (this->record)
+                  this->record->sequence = this->sequence; // publish
+            }
+            //
+            explicit operator bool() const { return this->record != nullptr; }
+            Record* operator->() const { return this->record; }
+            //
+            void WriteString(UInt32 firstField, const char* str); // copies into data starting at the given field, truncating if necessary
+      };
+
+      extern Entry Begin(Event);
+      extern void  Close();
+   }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+
+//
+// On-disk layout for the binary event trace written by Services/Trace.cpp. This header must
+// not depend on SKSE or on the game, because the standalone decoder in tools/TraceDecoder
+// includes it as well.
+//
+// The trace file is a single FileHeader followed by (capacity) fixed-size Records, used as a
+// ring buffer. Writers claim a slot by atomically incrementing the header's cursor; a record
+// whose sequence number is zero is either unused or was being written when the process died,
+// and should be ignored. Sorting the remaining records by sequence number yields the order in
+// which they were claimed.
+//
+namespace CobbBugFixes {
+   namespace TraceFormat {
+      constexpr uint32_t ce_magic      = 'CBTR';
+      constexpr uint32_t ce_version    = 1;
+      constexpr uint32_t ce_fieldCount = 12;
+
+      struct FileHeader {
+         uint32_t magic;          // 00
+         uint32_t version;        // 04
+         uint32_t recordSize;     // 08
+         uint32_t capacity;       // 0C // number of record slots following the header
+         uint64_t timerFrequency; // 10 // QueryPerformanceFrequency; used to convert timestamps to seconds
+         uint64_t timerStart;     // 18 // QueryPerformanceCounter when the trace was opened
+         volatile uint32_t cursor; // 20 // number of records ever claimed
+         uint32_t pad24[7];       // 24
+      };
+      static_assert(sizeof(FileHeader) == 0x40, "The trace file header must be 64 bytes.");
+
+      struct Record {
+         uint64_t timestamp; // 00 // QueryPerformanceCounter
+         volatile uint32_t sequence; // 08 // 1-based; zero if the slot was never (fully) written
+         uint16_t event;     // 0C
+         uint16_t thread;    // 0E // low 16 bits of the writing thread's ID
+         union {             // 10
+            uint32_t u[ce_fieldCount];
+            float    f[ce_fieldCount];
+            char     s[ce_fieldCount * 4];
+         } data;
+      };
+      static_assert(sizeof(Record) == 0x40, "Trace records must be 64 bytes.");
+
+      enum class Event : uint16_t {
+         none = 0,
+         archery_shot_node       = 1,
+         archery_shot_projectile = 2,
+         vampire_feed_anim_event = 3,
+      };
+
+      enum class FieldType : uint8_t {
+         none = 0, // unused field; also terminates the field list
+         u32,
+         hex32,    // pointers, flags
+         form_id,
+         f32,
+         str,      // NUL-padded string occupying this field and all fields after it
+      };
+      struct FieldSchema {
+         const char* name;
+         FieldType   type;
+      };
+      struct EventSchema {
+         Event       id;
+         const char* name;
+         FieldSchema fields[ce_fieldCount];
+      };
+
+      //
+      // Keep this in sync with the Event enum. Fields are listed in the order that writers
+      // store them in Record::data.
+      //
+      inline constexpr EventSchema g_events[] = {
+         { Event::archery_shot_node, "ArcheryShotNode", {
+            { "actor",   FieldType::form_id },
+            { "node",    FieldType::hex32 },
+            { "actorX",  FieldType::f32 },
+            { "actorY",  FieldType::f32 },
+            { "actorZ",  FieldType::f32 },
+            { "nodeX",   FieldType::f32 },
+            { "nodeY",   FieldType::f32 },
+            { "nodeZ",   FieldType::f32 },
+            { "rootX",   FieldType::f32 },
+            { "rootY",   FieldType::f32 },
+            { "rootZ",   FieldType::f32 },
+         }},
+         { Event::archery_shot_projectile, "ArcheryShotProjectile", {
+            { "projectile", FieldType::form_id },
+            { "base",       FieldType::form_id },
+            { "x",          FieldType::f32 },
+            { "y",          FieldType::f32 },
+            { "z",          FieldType::f32 },
+         }},
+         { Event::vampire_feed_anim_event, "VampireFeedAnimEvent", {
+            { "actor", FieldType::form_id },
+            { "event", FieldType::str },
+         }},
+      };
+      inline const EventSchema* GetEventSchema(uint16_t id) {
+         for (auto& schema : g_events)
+            if ((uint16_t)schema.id == id)
+               return &schema;
+         return nullptr;
+      }
+   }
+}
@@ -0,0 +1,75 @@
+#include "WaterSurface.h"
+#include "ReverseEngineered/Forms/TESObjectCELL.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <xmmintrin.h>
+
+namespace CobbBugFixes {
+   namespace WaterSurface {
+      //
+      // We don't share the Underwater Ambience Cell Boundary Fix's water level cache. It 
+      // only has room for the few cells around the camera, and queries for arbitrary points 
+      // would evict those; and since we already group points by cell, each cell is only 
+      // looked up once per call anyway.
+      //
+      constexpr float ce_cellSize = 4096.0F;
+      constexpr float ce_noWater  = -std::numeric_limits<float>::infinity();
+
+      UInt32 Query(RE::TESWorldSpace* world, const RE::NiPoint3* points, UInt32 count, float* outHeights, bool* outSubmerged) {
+         if (!count)
+            return 0;
+         if (!world) {
+            std::fill(outHeights, outHeights + count, ce_noWater);
+            std::fill(outSubmerged, outSubmerged + count, false);
+            return 0;
+         }
+         //
+         // Sort the points by exterior cell, so that each cell is looked up once.
+         //
+         struct _Item {
+            UInt64 key; // grid X and Y, packed
+            UInt32 index;
+         };
+         std::vector<_Item> order(count);
+         for (UInt32 i = 0; i < count; ++i) {
+            SInt32 x = (SInt32)std::floor(points[i].x / ce_cellSize);
+            SInt32 y = (SInt32)std::floor(points[i].y / ce_cellSize);
+            order[i] = { ((UInt64)(UInt32)x << 32) | (UInt32)y, i };
+         }
+         std::sort(order.begin(), order.end(), [](const _Item& a, const _Item& b) { return a.key < b.key; });
+         UInt32 found = 0;
+         for (UInt32 i = 0; i < count; ) {
+            UInt64 key = order[i].key;
+            RE::NiPoint3 pos(points[order[i].index]);
+            auto cell = CALL_MEMBER_FN(world, GetCellThatContainsPoint)(&pos);
+            if (cell) {
+               float water = CALL_MEMBER_FN(cell, GetWaterLevel)();
+               for (; i < count && order[i].key == key; ++i, ++found)
+                  outHeights[order[i].index] = water;
+            } else {
+               for (; i < count && order[i].key == key; ++i)
+                  outHeights[order[i].index] = ce_noWater;
+            }
+         }
+         //
+         // Submerged test, four points at a time. Points with no water have a height of 
+         // negative infinity, so they always compare as not submerged.
+         //
+         UInt32 i = 0;
+         for (; i + 4 <= count; i += 4) {
+            __m128 z = _mm_set_ps(points[i + 3].z, points[i + 2].z, points[i + 1].z, points[i].z);
+            __m128 h = _mm_loadu_ps(outHeights + i);
+            int mask = _mm_movemask_ps(_mm_cmplt_ps(z, h));
+            outSubmerged[i]     = (mask & 1) != 0;
+            outSubmerged[i + 1] = (mask & 2) != 0;
+            outSubmerged[i + 2] = (mask & 4) != 0;
+            outSubmerged[i + 3] = (mask & 8) != 0;
+         }
+         for (; i < count; ++i)
+            outSubmerged[i] = points[i].z < outHeights[i];
+         return found;
+      }
+   }
+}
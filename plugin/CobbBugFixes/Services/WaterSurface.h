@@ -0,0 +1,19 @@
+#pragma once
+#include "ReverseEngineered/Forms/TESWorldSpace.h"
+#include "ReverseEngineered/NetImmerse/nodes.h"
+
+namespace CobbBugFixes {
+   namespace WaterSurface {
+      //
+      // Finds the water height at each of (count) points in a worldspace, using the water 
+      // level of the exterior cell that actually contains each point (rather than, say, 
+      // the cell its actor is registered in), and whether each point is below it. This is 
+      // the same boundary-safe answer that the Underwater Ambience Cell Boundary Fix uses 
+      // for the camera. Points are grouped by cell, so each cell's water level is fetched 
+      // once per call. Points outside of any loaded cell get a height of negative infinity 
+      // and are never submerged. Returns the number of points that were in a cell. Main 
+      // thread only.
+      //
+      UInt32 Query(RE::TESWorldSpace* world, const RE::NiPoint3* points, UInt32 count, float* outHeights, bool* outSubmerged);
+   }
+}
@@ -7,8 +7,11 @@
 #pragma comment( lib, "psapi.lib" ) // needed for PSAPI to link properly
 #include <string>
 
+#include "Services/CoSave.h"
 #include "Services/INI.h"
 #include "Services/CrashLog.h"
+#include "Services/PackageTracer.h"
+#include "Services/PlayerAIDriven.h"
 #include "Patches/Exploratory.h"
 #include "Patches/ArcheryDownwardArrowFix.h"
 #include "Patches/ArmorAddonMO5SFix.h"
@@ -21,19 +24,29 @@
 #include "Patches/ModArmorWeightPerk.h"
 #include "Patches/TrainerFixes.h"
 #include "Patches/DetectShutdown.h"
+#include "Patches/PlayerAIDrivenRecovery.h"
+#include "Patches/ProjectileTrajectory.h"
 
 PluginHandle			       g_pluginHandle   = kPluginHandle_Invalid;
 SKSEMessagingInterface*     g_ISKSEMessaging = nullptr;
 SKSESerializationInterface* g_serialization  = nullptr;
+SKSETaskInterface*          g_ISKSETask      = nullptr;
 
 static const char* g_pluginName = "CobbBugFixes";
 const UInt32 g_pluginVersion   = 0x01060200; // 0xAABBCCDD = AA.BB.CC.DD with values converted to decimal // major.minor.update.internal-build-or-zero
 const UInt32 g_serializationID = 'cBug';
 
 void Callback_Messaging_SKSE(SKSEMessagingInterface::Message* message);
+void Callback_Messaging_Plugins(SKSEMessagingInterface::Message* message);
 void Callback_Serialization_Save(SKSESerializationInterface* intfc);
 void Callback_Serialization_Load(SKSESerializationInterface* intfc);
 
+BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved) {
+   if (reason == DLL_PROCESS_DETACH)
+      CobbBugFixes::Patches::DetectShutdown::OnDllDetach(reserved != nullptr); // (reserved) is non-null if the process is exiting, rather than us being unloaded
+   return TRUE;
+}
+
 extern "C" {
    //
    // SKSEPlugin_Query: Called by SKSE to learn about this plug-in and check that it's safe to load.
@@ -87,6 +100,15 @@ extern "C" {
             return false;
          }
       }
+      {  // Get the task interface and query its version. Only optional features need it, so we can do without.
+         g_ISKSETask = (SKSETaskInterface*)skse->QueryInterface(kInterface_Task);
+         if (!g_ISKSETask) {
+            _MESSAGE("Couldn't get task interface. Features that need it will be disabled.");
+         } else if (g_ISKSETask->interfaceVersion < SKSETaskInterface::kInterfaceVersion) {
+            _MESSAGE("Task interface too old (%d; we expected %d). Features that need it will be disabled.", g_ISKSETask->interfaceVersion, SKSETaskInterface::kInterfaceVersion);
+            g_ISKSETask = nullptr;
+         }
+      }
       {  // Get the serialization interface and query its version.
          g_serialization = (SKSESerializationInterface*)skse->QueryInterface(kInterface_Serialization);
          if (!g_serialization) {
@@ -110,6 +132,7 @@ extern "C" {
       SetupCrashLogging();
       CobbBugFixes::INISettingManager::GetInstance().Load();
       g_ISKSEMessaging->RegisterListener(g_pluginHandle, "SKSE", Callback_Messaging_SKSE);
+      g_ISKSEMessaging->RegisterListener(g_pluginHandle, nullptr, Callback_Messaging_Plugins); // messages from any plug-in
       {  // Patches:
          CobbBugFixes::Patches::Exploratory::Apply();
          CobbBugFixes::Patches::ArcheryDownwardArrowFix::Apply();
@@ -122,7 +145,10 @@ extern "C" {
          CobbBugFixes::Patches::ModArmorWeightPerk::Apply();
          CobbBugFixes::Patches::TrainerFixes::Apply();
          CobbBugFixes::Patches::DetectShutdown::Apply();
+         CobbBugFixes::Patches::PlayerAIDrivenRecovery::Apply();
+         CobbBugFixes::Patches::ProjectileTrajectory::Apply();
       }
+      CobbBugFixes::PlayerAIDriven::Start(g_ISKSETask); // after the patches that watch the player's AI-driven state
       {  // Serialization
          g_serialization->SetUniqueID(g_pluginHandle, g_serializationID);
          //g_serialization->SetRevertCallback(g_pluginHandle, Callback_Serialization_Revert);
@@ -137,39 +163,40 @@ void Callback_Messaging_SKSE(SKSEMessagingInterface::Message* message) {
    } else if (message->type == SKSEMessagingInterface::kMessage_PostPostLoad) {
       SetupCrashLogging();
    } else if (message->type == SKSEMessagingInterface::kMessage_DataLoaded) {
+      MerchantRestockFix::OnDataLoaded();
+      CobbBugFixes::Patches::UnderwaterAmbienceCellBoundaryFix::OnDataLoaded();
+      CobbBugFixes::PackageTracer::OnDataLoaded();
    } else if (message->type == SKSEMessagingInterface::kMessage_NewGame) {
    } else if (message->type == SKSEMessagingInterface::kMessage_PreLoadGame) {
    } else if (message->type == SKSEMessagingInterface::kMessage_PostLoadGame) {
       //CobbBugFixes::Patches::Exploratory::ModelLoadingTest::RunTest();
+      CobbBugFixes::Patches::Exploratory::ModelLoadingTest::RunBenchmark();
+   }
+};
+void Callback_Messaging_Plugins(SKSEMessagingInterface::Message* message) {
+   if (message->type == CobbBugFixes::Patches::ProjectileTrajectory::ce_registerMessage) {
+      _MESSAGE("Received a projectile trajectory adjuster from %s.", message->sender ? message->sender : "<unknown>");
+      CobbBugFixes::Patches::ProjectileTrajectory::OnMessage(message->data, message->dataLen);
    }
 };
 void Callback_Serialization_Save(SKSESerializationInterface* intfc) {
    _MESSAGE("Saving...");
-   if (MerchantRestockFix::Save(intfc)) {
-      _MESSAGE("Saving complete (or no data to save) for the merchant restock fix.");
-   } else {
-      _MESSAGE("Saving failed for the merchant restock fix.");
-   }
+   CobbBugFixes::CoSave::Manager::GetInstance().Save(intfc);
    _MESSAGE("Saving done!");
 }
 void Callback_Serialization_Load(SKSESerializationInterface* intfc) {
    _MESSAGE("Loading...");
    //
+   auto&  manager = CobbBugFixes::CoSave::Manager::GetInstance();
    UInt32 type;
    UInt32 version;
    UInt32 length;
-   bool   error = false;
    //
-   while (!error && intfc->GetNextRecordInfo(&type, &version, &length)) {
-      switch (type) {
-         case MerchantRestockFix::ce_recordSignature:
-            if (error = !MerchantRestockFix::Load(intfc, version))
-               _MESSAGE("Loading failed for the merchant restock fix.");
-            else
-               _MESSAGE("Loading complete for the merchant restock fix.");
-            break;
-      }
-   }
+   // The manager consumes each record in full, even if it's unrecognized or fails to load, 
+   // so one bad record doesn't prevent us from loading the rest.
+   //
+   while (intfc->GetNextRecordInfo(&type, &version, &length))
+      manager.Load(intfc, type, version, length);
    //
    _MESSAGE("Loading done!");
 }
\ No newline at end of file
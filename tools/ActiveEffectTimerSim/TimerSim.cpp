@@ -0,0 +1,320 @@
+//
+// Simulation driver for the Active Effect Timer Bugfix (Patches/ActiveEffectTimerMath.h in the
+// plugin). It replays synthetic frame-time traces over a population of simulated effects, using
+// the same steps as the patch: each frame advances the global timer (ManageTimer), then every
+// effect checks whether its conditions are due (ActiveEffectConditionInterval) and advances its
+// elapsed time (ActiveEffectAdvanceTime). Each effect also keeps an exact elapsed time, so that
+// we can see how far the game's float drifts from it and which condition checks are missed.
+//
+// This is a standalone program with no dependencies beyond the standard library; build and run
+// it with any C++17 compiler, e.g.:
+//
+//    g++ -std=c++17 -O2 -o timer-sim TimerSim.cpp
+//    ./timer-sim [--effects N] [--seconds N] [--seed N]
+//    ./timer-sim --matrix [--seed N]
+//
+// --matrix repeats the regression over a range of effect counts and trace lengths, printing
+// one line per combination instead of the full table. The effect count matters because it
+// decides how soon the shadow table fills up and the scheduler takes over.
+//
+// Each trace is run three ways: "vanilla" (the game's own float arithmetic), "fixed" (the
+// patch, with its shadow table and the phased scheduler as the fallback once the table fills
+// up), and "scheduler" (the patch with the shadow table always full). For each run we report:
+//
+//  - expected and actual condition checks, where "expected" counts the frames in which an
+//    effect's exact elapsed time crosses a multiple of the update interval;
+//  - missed checks: the total, over all effects, of expected checks that never ran, and the
+//    most missed by any one effect that was past the safety threshold for the whole run
+//    (effects below it use the game's own arithmetic by design);
+//  - drift: the largest difference between an effect's float elapsed time and its exact one;
+//  - cost: wall time per effect per frame, and the slowest frame.
+//
+// Exits with a non-zero status if, in the fixed or scheduler runs, an effect that was past the
+// threshold misses more than one check, or if an effect tracked by the shadow table drifts by
+// more than half a float ULP.
+//
+#include "../../plugin/CobbBugFixes/Patches/ActiveEffectTimerMath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace CobbBugFixes::Patches::ActiveEffectTimerBugs;
+
+namespace {
+   constexpr double ce_interval = 1.0; // fActiveEffectConditionUpdateInterval's default value
+
+   struct Options {
+      uint32_t effects = 10000;
+      double   seconds = 30.0; // of actor time per trace, not counting skips
+      uint32_t seed    = 12345;
+   };
+
+   //
+   // Frame-time traces.
+   //
+   struct Trace {
+      const char* name;
+      double fps;
+      double skipEvery;   // seconds of ordinary frames between skips; zero for none
+      double skipSeconds; // length of each skip
+   };
+   const Trace g_traces[] = {
+      { "30 fps",                30.0,  0.0,    0.0 },
+      { "60 fps",                60.0,  0.0,    0.0 },
+      { "120 fps",              120.0,  0.0,    0.0 },
+      { "240 fps",              240.0,  0.0,    0.0 },
+      { "60 fps, timescale skips", 60.0, 10.0,  20.0 },
+      { "60 fps, one-hour waits",  60.0, 15.0, 3600.0 },
+   };
+   std::vector<float> build_frames(const Trace& trace, const Options& options) {
+      std::mt19937 rng(options.seed);
+      std::uniform_real_distribution<double> jitter(0.9, 1.1);
+      std::vector<float> frames;
+      double sinceSkip = 0.0;
+      for (double t = 0.0; t < options.seconds; ) {
+         float delta = (float)(jitter(rng) / trace.fps);
+         frames.push_back(delta);
+         t         += delta;
+         sinceSkip += delta;
+         if (trace.skipEvery > 0.0 && sinceSkip >= trace.skipEvery) {
+            frames.push_back((float)trace.skipSeconds);
+            sinceSkip = 0.0;
+         }
+      }
+      return frames;
+   }
+
+   enum class Mode {
+      vanilla,
+      fixed,
+      scheduler,
+   };
+   const char* mode_name(Mode m) {
+      switch (m) {
+         case Mode::vanilla:   return "vanilla";
+         case Mode::fixed:     return "fixed";
+         case Mode::scheduler: return "scheduler";
+      }
+      return "?";
+   }
+
+   struct Effect {
+      const void* key;         // stands in for the ActiveEffect pointer; never dereferenced
+      float       elapsed;     // ActiveEffect::elapsed, as the game sees it
+      double      exact;       // the true elapsed time
+      uint32_t    expected = 0;
+      uint32_t    actual   = 0;
+      bool        past     = false; // past the safety threshold from the start?
+      bool        shadowed = false; // was the last advance done through the shadow table?
+      double      takeover = 0.0;   // (elapsed - exact) when the shadow table last took the effect over
+   };
+   struct Result {
+      uint64_t expected = 0;
+      uint64_t actual   = 0;
+      uint64_t missed   = 0;
+      uint32_t worstMissed    = 0; // most checks missed by a single effect that was past the threshold
+      double   drift          = 0.0;
+      double   shadowDrift    = 0.0; // drift, divided by the float ULP at that value, for shadowed effects
+      uint32_t shadowed       = 0;
+      double   nsPerEffect    = 0.0;
+      double   peakFrameMicro = 0.0;
+   };
+
+   //
+   // The patch's state and steps, as in ActiveEffectTimerBugs.cpp, minus the game and the locking.
+   //
+   class Simulation {
+      public:
+         typedef Math::ShadowTable<const void*> Table;
+         //
+         Mode  mode;
+         Math::RolloverTimer timer;
+         std::unique_ptr<Table> table;
+         double clock = 0.0; // Scheduler::s_clock
+         //
+         explicit Simulation(Mode m) : mode(m), table(new Table) {}
+         //
+         void BeginFrame(float delta) { // ManageTimer::Inner
+            this->table->Tick();
+            this->clock += delta;
+            this->timer.Advance(delta, (float)ce_interval);
+         }
+         bool ShouldUpdate(Effect& e, float delta) { // ActiveEffectConditionInterval::_shouldUpdate
+            double elapsed = e.elapsed;
+            if (this->mode == Mode::vanilla || elapsed < Math::ce_safetyThreshold)
+               return Math::VanillaConditionDue(elapsed, delta, ce_interval);
+            if (this->mode == Mode::fixed) {
+               Math::fixed_t current;
+               if (this->table->Get(e.key, e.elapsed, current))
+                  return Math::FixedConditionDue(current, delta, ce_interval);
+            }
+            return Math::PhasedConditionDue(this->clock, Math::Phase(e.key), delta, ce_interval);
+         }
+         void Advance(Effect& e, float delta) { // ActiveEffectAdvanceTime::Inner
+            e.shadowed = false;
+            if (this->mode == Mode::vanilla || e.elapsed < Math::ce_safetyThreshold) {
+               e.elapsed += delta;
+               return;
+            }
+            if (this->mode == Mode::fixed && this->table->Advance(e.key, e.elapsed, delta)) {
+               e.shadowed = true;
+               return;
+            }
+            if (this->timer.value >= ce_interval)
+               e.elapsed += this->timer.value;
+         }
+   };
+
+   //
+   // The shadow table starts from whatever float elapsed time an effect has when the table 
+   // takes it over, and effects that cross the threshold during the run arrive already 
+   // carrying drift from the game's own arithmetic. So the shadowed drift we gate on is 
+   // measured from the drift the effect had at takeover, not from zero.
+   //
+   std::vector<Effect> build_effects(const Options& options) {
+      std::mt19937 rng(options.seed ^ 0x5EED);
+      std::uniform_real_distribution<double> below(0.0, 30.0);     // will cross the threshold during the run
+      std::uniform_real_distribution<double> above(0.0, 262144.0); // already past it
+      std::vector<Effect> effects(options.effects);
+      for (uint32_t i = 0; i < options.effects; ++i) {
+         auto& e = effects[i];
+         e.key     = (const void*)(uintptr_t)(0x10000000 + i * 0x90); // roughly how ActiveEffects are spaced in memory
+         e.elapsed = (float)(i & 1 ? Math::ce_safetyThreshold + above(rng) : Math::ce_safetyThreshold - below(rng));
+         e.exact   = e.elapsed;
+         e.past    = e.elapsed >= Math::ce_safetyThreshold;
+      }
+      return effects;
+   }
+
+   Result run(Mode mode, const std::vector<float>& frames, const Options& options) {
+      Simulation sim(mode);
+      auto   effects = build_effects(options);
+      Result r;
+      double totalNs = 0.0;
+      for (float delta : frames) {
+         auto start = std::chrono::steady_clock::now();
+         sim.BeginFrame(delta);
+         for (auto& e : effects) {
+            if (sim.ShouldUpdate(e, delta))
+               ++e.actual;
+            bool  wasShadowed = e.shadowed;
+            float before      = e.elapsed;
+            sim.Advance(e, delta);
+            if (e.shadowed && !wasShadowed)
+               e.takeover = (double)before - e.exact; // (exact) hasn't been advanced for this frame yet
+         }
+         double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+         totalNs += ns;
+         r.peakFrameMicro = std::max(r.peakFrameMicro, ns / 1000.0);
+         //
+         // Bookkeeping against the exact elapsed times; not timed.
+         //
+         for (auto& e : effects) {
+            if (Math::VanillaConditionDue(e.exact, delta, ce_interval))
+               ++e.expected;
+            e.exact += delta;
+         }
+      }
+      for (auto& e : effects) {
+         r.expected += e.expected;
+         r.actual   += e.actual;
+         uint32_t missed = e.expected > e.actual ? e.expected - e.actual : 0;
+         r.missed += missed;
+         if (e.past)
+            r.worstMissed = std::max(r.worstMissed, missed);
+         double drift = std::fabs((double)e.elapsed - e.exact);
+         r.drift = std::max(r.drift, drift);
+         if (e.shadowed) {
+            ++r.shadowed;
+            double ulp = (double)std::nextafter(e.elapsed, INFINITY) - e.elapsed;
+            r.shadowDrift = std::max(r.shadowDrift, std::fabs((double)e.elapsed - e.exact - e.takeover) / ulp);
+         }
+      }
+      r.nsPerEffect = totalNs / ((double)frames.size() * effects.size());
+      return r;
+   }
+
+   //
+   // Runs every trace in every mode, and returns the number of failed checks. If (table) is
+   // set, prints a row per run; otherwise, only failures are printed.
+   //
+   uint32_t run_all(const Options& options, bool table) {
+      if (table) {
+         printf("%u effects, %.0f seconds per trace, seed %u.\n\n", options.effects, options.seconds, options.seed);
+         printf("%-24s %-10s %12s %12s %10s %6s %12s %9s %8s %10s\n", "trace", "mode", "expected", "actual", "missed", "worst", "drift (s)", "shadowed", "ns/eff", "peak (us)");
+      }
+      uint32_t failures = 0;
+      for (auto& trace : g_traces) {
+         auto frames = build_frames(trace, options);
+         for (Mode mode : { Mode::vanilla, Mode::fixed, Mode::scheduler }) {
+            Result r = run(mode, frames, options);
+            if (table) {
+               printf("%-24s %-10s %12llu %12llu %10llu %6u %12.4f %9u %8.2f %10.1f\n",
+                  trace.name,
+                  mode_name(mode),
+                  (unsigned long long)r.expected,
+                  (unsigned long long)r.actual,
+                  (unsigned long long)r.missed,
+                  r.worstMissed,
+                  r.drift,
+                  r.shadowed,
+                  r.nsPerEffect,
+                  r.peakFrameMicro
+               );
+            }
+            if (mode != Mode::vanilla) {
+               if (r.worstMissed > 1) {
+                  fprintf(stderr, "FAILED: %u effects, %.0f seconds, %s, %s: an effect missed %u condition checks.\n", options.effects, options.seconds, trace.name, mode_name(mode), r.worstMissed);
+                  ++failures;
+               }
+               if (r.shadowDrift > 0.5) {
+                  fprintf(stderr, "FAILED: %u effects, %.0f seconds, %s, %s: a shadowed effect drifted by %.2f ULP.\n", options.effects, options.seconds, trace.name, mode_name(mode), r.shadowDrift);
+                  ++failures;
+               }
+            }
+         }
+      }
+      return failures;
+   }
+}
+
+int main(int argc, char** argv) {
+   Options options;
+   bool    matrix = false;
+   for (int i = 1; i < argc; ++i) {
+      if (!strcmp(argv[i], "--effects") && i + 1 < argc)
+         options.effects = strtoul(argv[++i], nullptr, 0);
+      else if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+         options.seconds = strtod(argv[++i], nullptr);
+      else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+         options.seed = strtoul(argv[++i], nullptr, 0);
+      else if (!strcmp(argv[i], "--matrix"))
+         matrix = true;
+   }
+   if (!matrix)
+      return run_all(options, true) ? 1 : 0;
+   //
+   // Effect counts on either side of the point where the effects that start past the
+   // threshold fill the shadow table by themselves, and trace lengths short enough that
+   // few effects cross the threshold as well as long enough that most do.
+   //
+   const uint32_t counts[]  = { 500, 2000, 6000, 7000, 10000, 20000 };
+   const double   seconds[] = { 5.0, 20.0, 30.0, 60.0 };
+   uint32_t failures = 0;
+   for (uint32_t count : counts) {
+      for (double length : seconds) {
+         options.effects = count;
+         options.seconds = length;
+         uint32_t f = run_all(options, false);
+         printf("%6u effects, %3.0f seconds: %s\n", count, length, f ? "FAILED" : "passed");
+         failures += f;
+      }
+   }
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+//
+// Truncation and fuzz tests for the co-save record reader (Services/CoSave in the plugin),
+// run against an in-memory SKSESerializationInterface. Build and run it with any C++17
+// compiler, e.g.:
+//
+//    g++ -std=c++17 -O2 -Wno-multichar -Ishim -o cosave-fuzz Fuzz.cpp ../../plugin/CobbBugFixes/Services/CoSave.cpp
+//    ./cosave-fuzz [--verbose] [--seed N] [--iterations N]
+//
+// Every test ends a co-save with a sentinel record, and checks that no matter how damaged
+// the records before it are, the sentinel still loads intact. Exits with a non-zero status
+// if any check fails; the seed is printed so that failures can be reproduced.
+//
+#include "MemorySerialization.h"
+#include "../../plugin/CobbBugFixes/Services/CoSave.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace CobbBugFixes;
+
+bool g_verbose = false;
+
+namespace {
+   UInt32 s_failures = 0;
+   UInt32 s_checks   = 0;
+   #define CHECK(condition) do { ++s_checks; if (!(condition)) { ++s_failures; fprintf(stderr, "FAILED: %s (line %d)\n", #condition, __LINE__); } } while (0)
+
+   constexpr UInt32 ce_sentinelMagic = 0xC0BBF00D;
+   //
+   struct Entry {
+      UInt32 formID;
+      float  value;
+   };
+   UInt32 s_lastLength  = 0; // length of the 'Arr ' record being loaded
+   size_t s_largestRead = 0; // largest array ReadArray produced, in bytes
+   UInt32 s_sentinels   = 0; // intact sentinels loaded
+
+   bool save_nothing(SKSESerializationInterface*) {
+      return true;
+   }
+   bool load_array(CoSave::RecordReader& reader) {
+      std::vector<Entry> entries;
+      bool ok = reader.ReadArray(entries);
+      if (entries.size() * sizeof(Entry) > s_largestRead)
+         s_largestRead = entries.size() * sizeof(Entry);
+      CHECK(entries.size() * sizeof(Entry) <= s_lastLength); // never allocates more than the record could hold
+      return ok;
+   }
+   bool load_sentinel(CoSave::RecordReader& reader) {
+      UInt32 magic = 0;
+      UInt32 index = 0;
+      if (!reader.Read(magic) || !reader.Read(index))
+         return false;
+      if (magic == ce_sentinelMagic && index == s_sentinels)
+         ++s_sentinels;
+      return true;
+   }
+   CoSave::RecordCodec s_arrayCodec("array records", 'Arr ', 1, &save_nothing, &load_array);
+   CoSave::RecordCodec s_sentinelCodec("sentinel records", 'Sent', 1, &save_nothing, &load_sentinel);
+
+   void write_sentinel(UInt32 index) {
+      UInt32 data[2] = { ce_sentinelMagic, index };
+      MemorySerialization::Interface()->WriteRecord('Sent', 1, data, sizeof(data));
+   }
+   void write_raw(UInt32 type, UInt32 version, const std::vector<UInt8>& bytes) {
+      MemorySerialization::Interface()->WriteRecord(type, version, bytes.data(), (UInt32)bytes.size());
+   }
+   std::vector<UInt8> valid_array(UInt32 count) {
+      std::vector<UInt8> bytes(sizeof(UInt32) + count * sizeof(Entry));
+      memcpy(bytes.data(), &count, sizeof(count));
+      for (UInt32 i = 0; i < count; ++i) {
+         Entry e = { 0x01000000 | i, (float)i };
+         memcpy(bytes.data() + sizeof(UInt32) + i * sizeof(Entry), &e, sizeof(e));
+      }
+      return bytes;
+   }
+   //
+   // Loads everything, mirroring Callback_Serialization_Load in main.cpp. Returns the number
+   // of records that failed to load.
+   //
+   UInt32 load_all() {
+      auto   intfc   = MemorySerialization::Interface();
+      auto&  manager = CoSave::Manager::GetInstance();
+      auto&  store   = MemorySerialization::Current();
+      UInt32 type, version, length;
+      UInt32 failed = 0;
+      s_sentinels = 0;
+      store.Rewind();
+      while (intfc->GetNextRecordInfo(&type, &version, &length)) {
+         s_lastLength = length;
+         if (!manager.Load(intfc, type, version, length))
+            ++failed;
+         CHECK(store.offset == length); // the manager always consumes the whole record
+      }
+      return failed;
+   }
+
+   void test_reader_basics() {
+      MemorySerialization::Reset();
+      UInt32 data[2] = { 1, 2 };
+      auto intfc = MemorySerialization::Interface();
+      intfc->WriteRecord('Arr ', 1, data, sizeof(data));
+      MemorySerialization::Current().Rewind();
+      UInt32 type, version, length;
+      intfc->GetNextRecordInfo(&type, &version, &length);
+      //
+      CoSave::RecordReader reader(intfc, length);
+      UInt32 a = 0;
+      UInt64 b = 0;
+      CHECK(reader.Read(a) && a == 1);
+      CHECK(reader.Remaining() == 4);
+      CHECK(!reader.Read(b)); // would run past the end
+      CHECK(reader.Failed());
+      CHECK(!reader.Read(a)); // failure is sticky, even though four bytes remain
+      reader.SkipToEnd();
+      CHECK(reader.Remaining() == 0);
+   }
+   void test_every_truncation() {
+      auto full = valid_array(16);
+      for (size_t cut = 0; cut < full.size(); ++cut) {
+         MemorySerialization::Reset();
+         write_raw('Arr ', 1, std::vector<UInt8>(full.begin(), full.begin() + cut));
+         write_sentinel(0);
+         UInt32 failed = load_all();
+         CHECK(failed == 1);
+         CHECK(s_sentinels == 1);
+      }
+      MemorySerialization::Reset();
+      write_raw('Arr ', 1, full);
+      write_sentinel(0);
+      CHECK(load_all() == 0);
+      CHECK(s_sentinels == 1);
+   }
+   void test_huge_counts() {
+      const UInt32 counts[] = { 0xFFFFFFFF, 0x80000000, 0x20000000, 17 };
+      for (auto count : counts) {
+         MemorySerialization::Reset();
+         auto bytes = valid_array(16);
+         memcpy(bytes.data(), &count, sizeof(count));
+         write_raw('Arr ', 1, bytes);
+         write_sentinel(0);
+         s_largestRead = 0;
+         CHECK(load_all() == 1);
+         CHECK(s_largestRead == 0); // rejected before allocating
+         CHECK(s_sentinels == 1);
+      }
+   }
+   void test_random(UInt32 seed, UInt32 iterations) {
+      std::mt19937 rng(seed);
+      auto roll = [&rng](UInt32 n) { return (UInt32)(rng() % n); };
+      for (UInt32 it = 0; it < iterations; ++it) {
+         MemorySerialization::Reset();
+         UInt32 records   = 1 + roll(8);
+         UInt32 sentinels = 0;
+         for (UInt32 i = 0; i < records; ++i) {
+            std::vector<UInt8> bytes;
+            UInt32 type    = 'Arr ';
+            UInt32 version = 1;
+            switch (roll(6)) {
+               case 0: // valid
+                  bytes = valid_array(roll(64));
+                  break;
+               case 1: // truncated
+                  bytes = valid_array(1 + roll(64));
+                  bytes.resize(roll((UInt32)bytes.size()));
+                  break;
+               case 2: // random bytes
+                  bytes.resize(roll(512));
+                  for (auto& b : bytes)
+                     b = (UInt8)rng();
+                  break;
+               case 3: // valid with random bit flips
+                  bytes = valid_array(roll(64));
+                  for (UInt32 flips = roll(8); flips; --flips)
+                     bytes[roll((UInt32)bytes.size())] ^= (UInt8)(1 << roll(8));
+                  break;
+               case 4: // unknown type or unsupported version
+                  bytes.resize(roll(256));
+                  if (roll(2))
+                     type = rng();
+                  else
+                     version = 2 + roll(100);
+                  break;
+               case 5:
+                  write_sentinel(sentinels++);
+                  continue;
+            }
+            write_raw(type, version, bytes);
+         }
+         write_sentinel(sentinels++);
+         load_all();
+         CHECK(s_sentinels == sentinels);
+      }
+   }
+}
+
+int main(int argc, char** argv) {
+   UInt32 seed       = 12345;
+   UInt32 iterations = 20000;
+   for (int i = 1; i < argc; ++i) {
+      if (!strcmp(argv[i], "--verbose"))
+         g_verbose = true;
+      else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+         seed = strtoul(argv[++i], nullptr, 0);
+      else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+         iterations = strtoul(argv[++i], nullptr, 0);
+   }
+   test_reader_basics();
+   test_every_truncation();
+   test_huge_counts();
+   test_random(seed, iterations);
+   printf("Seed %u: %u of %u checks passed.\n", seed, s_checks - s_failures, s_checks);
+   return s_failures ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#pragma once
+//
+// An in-memory SKSESerializationInterface. Records written through it are kept in a list,
+// and reading them back behaves the way SKSE's co-save reader does: GetNextRecordInfo moves
+// to the next record (discarding whatever was left unread in the current one), and
+// ReadRecordData never reads past the end of the current record.
+//
+#include "skse/PluginAPI.h"
+#include <cstring>
+#include <vector>
+
+namespace MemorySerialization {
+   struct Record {
+      UInt32 type;
+      UInt32 version;
+      std::vector<UInt8> data;
+   };
+   struct Store {
+      std::vector<Record> records;
+      bool   open  = false; // is a record open for writing?
+      size_t next  = 0;     // index of the next record GetNextRecordInfo will return
+      size_t current = SIZE_MAX;
+      size_t offset  = 0;   // read position in the current record
+      //
+      UInt32 writeCalls = 0; // WriteRecordData calls
+      UInt32 readCalls  = 0; // ReadRecordData calls
+      UInt32 resolveCalls = 0;
+      //
+      // Load order remapping used by ResolveFormId: maps a saved mod index to a current one,
+      // or to 0xFF if the mod is no longer loaded.
+      //
+      UInt8 modIndexMap[256];
+      //
+      Store() {
+         for (int i = 0; i < 256; ++i)
+            this->modIndexMap[i] = (UInt8)i;
+      }
+      void Rewind() { // prepare to read back what was written
+         this->open    = false;
+         this->next    = 0;
+         this->current = SIZE_MAX;
+         this->offset  = 0;
+      }
+   };
+   inline Store& Current() {
+      static Store store;
+      return store;
+   }
+   inline void Reset() {
+      Current() = Store();
+   }
+
+   inline bool _openRecord(UInt32 type, UInt32 version) {
+      auto& s = Current();
+      s.records.push_back({ type, version, {} });
+      s.open = true;
+      return true;
+   }
+   inline bool _writeRecordData(const void* buf, UInt32 length) {
+      auto& s = Current();
+      ++s.writeCalls;
+      if (!s.open)
+         return false;
+      auto& data = s.records.back().data;
+      auto  p    = (const UInt8*)buf;
+      data.insert(data.end(), p, p + length);
+      return true;
+   }
+   inline bool _writeRecord(UInt32 type, UInt32 version, const void* buf, UInt32 length) {
+      return _openRecord(type, version) && _writeRecordData(buf, length);
+   }
+   inline bool _getNextRecordInfo(UInt32* type, UInt32* version, UInt32* length) {
+      auto& s = Current();
+      if (s.next >= s.records.size())
+         return false;
+      s.current = s.next++;
+      s.offset  = 0;
+      auto& r = s.records[s.current];
+      *type    = r.type;
+      *version = r.version;
+      *length  = (UInt32)r.data.size();
+      return true;
+   }
+   inline UInt32 _readRecordData(void* buf, UInt32 length) {
+      auto& s = Current();
+      ++s.readCalls;
+      if (s.current >= s.records.size())
+         return 0;
+      auto&  data  = s.records[s.current].data;
+      size_t avail = data.size() - s.offset;
+      UInt32 count = length < avail ? length : (UInt32)avail;
+      if (count)
+         memcpy(buf, data.data() + s.offset, count);
+      s.offset += count;
+      return count;
+   }
+   inline bool _resolveFormId(UInt32 formId, UInt32* formIdOut) {
+      auto& s = Current();
+      ++s.resolveCalls;
+      UInt8 mapped = s.modIndexMap[formId >> 24];
+      if (mapped == 0xFF)
+         return false;
+      *formIdOut = ((UInt32)mapped << 24) | (formId & 0x00FFFFFF);
+      return true;
+   }
+
+   inline SKSESerializationInterface* Interface() {
+      static SKSESerializationInterface intfc = {
+         SKSESerializationInterface::kVersion,
+         _writeRecord,
+         _openRecord,
+         _writeRecordData,
+         _getNextRecordInfo,
+         _readRecordData,
+         _resolveFormId,
+      };
+      return &intfc;
+   }
+}
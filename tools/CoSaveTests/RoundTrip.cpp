@@ -0,0 +1,198 @@
+//
+// Round-trip tests for the co-save record framework (Services/CoSave in the plugin), run
+// against an in-memory SKSESerializationInterface. This is a standalone program with no
+// dependencies beyond the standard library; build and run it with any C++17 compiler, e.g.:
+//
+//    g++ -std=c++17 -O2 -Wno-multichar -Ishim -o cosave-roundtrip RoundTrip.cpp ../../plugin/CobbBugFixes/Services/CoSave.cpp
+//    ./cosave-roundtrip [--verbose]
+//
+// Exits with a non-zero status if any check fails.
+//
+#include "MemorySerialization.h"
+#include "../../plugin/CobbBugFixes/Services/CoSave.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace CobbBugFixes;
+
+bool g_verbose = false;
+
+namespace {
+   UInt32 s_failures = 0;
+   UInt32 s_checks   = 0;
+   #define CHECK(condition) do { ++s_checks; if (!(condition)) { ++s_failures; fprintf(stderr, "FAILED: %s (line %d)\n", #condition, __LINE__); } } while (0)
+
+   void load_all() { // mirrors Callback_Serialization_Load in main.cpp
+      auto   intfc = MemorySerialization::Interface();
+      auto&  manager = CoSave::Manager::GetInstance();
+      UInt32 type, version, length;
+      MemorySerialization::Current().Rewind();
+      while (intfc->GetNextRecordInfo(&type, &version, &length))
+         manager.Load(intfc, type, version, length);
+   }
+
+   //
+   // A fixed-layout record type, written in bulk. Version 2 is current; version 1 stored
+   // only form IDs, and is migrated.
+   //
+   struct Entry {
+      UInt32 formID;
+      float  value;
+      UInt32 flags;
+   };
+   bool operator==(const Entry& a, const Entry& b) {
+      return a.formID == b.formID && a.value == b.value && a.flags == b.flags;
+   }
+   std::vector<Entry> s_saved;
+   std::vector<Entry> s_loaded;
+   UInt32 s_migratedFrom = 0;
+   UInt32 s_loadCalls    = 0;
+
+   bool save_entries(SKSESerializationInterface* intfc) {
+      if (!intfc->OpenRecord('Tst1', 2))
+         return false;
+      return CoSave::WriteArray(intfc, s_saved);
+   }
+   bool load_entries(CoSave::RecordReader& reader) {
+      ++s_loadCalls;
+      return reader.ReadArray(s_loaded);
+   }
+   bool migrate_entries(CoSave::RecordReader& reader, UInt32 version) {
+      s_migratedFrom = version;
+      std::vector<UInt32> ids;
+      if (!reader.ReadArray(ids))
+         return false;
+      s_loaded.clear();
+      for (auto id : ids)
+         s_loaded.push_back({ id, 1.0F, 0 });
+      return true;
+   }
+   CoSave::RecordCodec s_entryCodec("test entries", 'Tst1', 2, &save_entries, &load_entries, &migrate_entries);
+
+   //
+   // A second record type, so we can check that problems with one record don't affect the
+   // next. Its load callback deliberately reads only part of the record.
+   //
+   UInt32 s_partialValue = 0;
+   bool save_partial(SKSESerializationInterface* intfc) {
+      UInt32 data[3] = { 0x11111111, 0x22222222, 0x33333333 };
+      return intfc->WriteRecord('Tst2', 1, data, sizeof(data));
+   }
+   bool load_partial(CoSave::RecordReader& reader) {
+      return reader.Read(s_partialValue);
+   }
+   CoSave::RecordCodec s_partialCodec("partial reader", 'Tst2', 1, &save_partial, &load_partial);
+
+   void reset() {
+      MemorySerialization::Reset();
+      s_loaded.clear();
+      s_migratedFrom = 0;
+      s_loadCalls    = 0;
+      s_partialValue = 0;
+   }
+
+   void test_bulk_round_trip() {
+      reset();
+      s_saved.clear();
+      for (UInt32 i = 0; i < 1000; ++i)
+         s_saved.push_back({ 0x01000000 | i, i * 0.5F, i & 7 });
+      CoSave::Manager::GetInstance().Save(MemorySerialization::Interface());
+      //
+      auto& store = MemorySerialization::Current();
+      CHECK(store.records.size() == 2);
+      CHECK(store.records[0].data.size() == sizeof(UInt32) + sizeof(Entry) * s_saved.size());
+      CHECK(store.writeCalls == 2 + 1); // count and elements for the array; one WriteRecord for the partial record
+      //
+      load_all();
+      CHECK(s_loadCalls == 1);
+      CHECK(s_loaded == s_saved);
+      CHECK(s_partialValue == 0x11111111);
+   }
+   void test_empty_array() {
+      reset();
+      s_saved.clear();
+      CoSave::Manager::GetInstance().Save(MemorySerialization::Interface());
+      auto& store = MemorySerialization::Current();
+      CHECK(store.records[0].data.size() == sizeof(UInt32));
+      s_loaded.push_back({ 1, 2.0F, 3 });
+      load_all();
+      CHECK(s_loaded.empty());
+   }
+   void test_migration() {
+      reset();
+      std::vector<UInt32> ids = { 0x01000001, 0x01000002, 0x02000003 };
+      auto intfc = MemorySerialization::Interface();
+      intfc->OpenRecord('Tst1', 1);
+      CoSave::WriteArray(intfc, ids);
+      load_all();
+      CHECK(s_migratedFrom == 1);
+      CHECK(s_loadCalls == 0);
+      CHECK(s_loaded.size() == 3 && s_loaded[2].formID == 0x02000003);
+   }
+   void test_newer_version_skipped() {
+      reset();
+      auto   intfc = MemorySerialization::Interface();
+      UInt32 junk[4] = { 99, 1, 2, 3 };
+      intfc->WriteRecord('Tst1', 3, junk, sizeof(junk));
+      save_partial(intfc);
+      load_all();
+      CHECK(s_loadCalls == 0);
+      CHECK(s_migratedFrom == 0);
+      CHECK(s_partialValue == 0x11111111);
+   }
+   void test_unknown_record_skipped() {
+      reset();
+      auto   intfc = MemorySerialization::Interface();
+      UInt32 junk[64] = {};
+      intfc->WriteRecord('Nope', 1, junk, sizeof(junk));
+      save_partial(intfc);
+      load_all();
+      CHECK(s_partialValue == 0x11111111);
+   }
+   void test_partial_read_skips_rest() {
+      reset();
+      auto intfc = MemorySerialization::Interface();
+      save_partial(intfc);
+      s_saved = { { 0x01000005, 5.0F, 5 } };
+      save_entries(intfc);
+      load_all();
+      CHECK(s_partialValue == 0x11111111);
+      CHECK(s_loaded == s_saved);
+   }
+   void test_resolve_form_ids() {
+      reset();
+      auto& store = MemorySerialization::Current();
+      store.modIndexMap[0x01] = 0x05;
+      store.modIndexMap[0x02] = 0xFF; // no longer loaded
+      store.modIndexMap[0x03] = 0x03;
+      std::vector<Entry> records;
+      for (UInt32 i = 0; i < 30; ++i)
+         records.push_back({ ((i % 3 + 1) << 24) | i, 0.0F, i });
+      UInt32 missing = CoSave::ResolveFormIDs(MemorySerialization::Interface(), records, &Entry::formID);
+      CHECK(missing == 10);
+      CHECK(store.resolveCalls == 3); // once per distinct mod index, not once per record
+      for (auto& r : records) {
+         switch (r.flags % 3) {
+            case 0: CHECK(r.formID == (0x05000000 | r.flags)); break;
+            case 1: CHECK(r.formID == 0); break;
+            case 2: CHECK(r.formID == (0x03000000 | r.flags)); break;
+         }
+      }
+   }
+}
+
+int main(int argc, char** argv) {
+   for (int i = 1; i < argc; ++i)
+      if (!strcmp(argv[i], "--verbose"))
+         g_verbose = true;
+   test_bulk_round_trip();
+   test_empty_array();
+   test_migration();
+   test_newer_version_skipped();
+   test_unknown_record_skipped();
+   test_partial_read_skips_rest();
+   test_resolve_form_ids();
+   printf("%u of %u checks passed.\n", s_checks - s_failures, s_checks);
+   return s_failures ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+//
+// Minimal stand-in for SKSE's PluginAPI.h, so that Services/CoSave can be compiled and
+// tested outside of the game. Only the parts of SKSESerializationInterface that CoSave
+// uses are declared; their names and signatures match SKSE's.
+//
+#include <cstdint>
+#include <cstdio>
+
+typedef uint8_t  UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef uint64_t UInt64;
+typedef int32_t  SInt32;
+
+extern bool g_verbose;
+#define _MESSAGE(...) do { if (g_verbose) { printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+struct SKSESerializationInterface {
+   enum { kVersion = 4 };
+   //
+   UInt32 version;
+   bool   (*WriteRecord)(UInt32 type, UInt32 version, const void* buf, UInt32 length);
+   bool   (*OpenRecord)(UInt32 type, UInt32 version);
+   bool   (*WriteRecordData)(const void* buf, UInt32 length);
+   bool   (*GetNextRecordInfo)(UInt32* type, UInt32* version, UInt32* length);
+   UInt32 (*ReadRecordData)(void* buf, UInt32 length);
+   bool   (*ResolveFormId)(UInt32 formId, UInt32* formIdOut);
+};
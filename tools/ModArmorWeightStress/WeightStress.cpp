@@ -0,0 +1,134 @@
+//
+// Thread stress test for the Mod Armor Weight stack fix (Patches/ModArmorWeightPerkMath.h in
+// the plugin). Many threads compute stack weights at once, with a perk that yields between
+// writing the weight copy and reading it back, and every result is checked against the same
+// computation done with no shared state at all. This is a standalone program with no
+// dependencies beyond the standard library; build and run it with any C++17 compiler, e.g.:
+//
+//    g++ -std=c++17 -O2 -pthread -o weight-stress WeightStress.cpp
+//    ./weight-stress [--threads N] [--iterations N] [--shared]
+//
+// With --shared, the test instead uses a single copy shared by all threads, as the patch did
+// before the copy was made thread-local; that run should report mismatches, which shows that
+// the test can catch the race. Exits with a non-zero status if the thread-local run has any
+// mismatch.
+//
+#include "../../plugin/CobbBugFixes/Patches/ModArmorWeightPerkMath.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace CobbBugFixes::Patches::ModArmorWeightPerk;
+
+namespace {
+   struct Options {
+      uint32_t threads    = 0; // zero means twice the hardware concurrency
+      uint32_t iterations = 200000;
+      bool     shared     = false;
+   };
+
+   std::atomic<bool> s_go(false);
+   std::atomic<uint32_t> s_mismatches(0);
+   std::atomic<uint64_t> s_stacks(0);
+
+   volatile float s_sharedWeight; // the pre-fix approach: one copy for every thread
+   float StackWeightShared(float weight, uint32_t count, bool worn, float factor) {
+      float total = 0.0F;
+      if (worn && count) {
+         s_sharedWeight = weight;
+         std::this_thread::yield();
+         s_sharedWeight = s_sharedWeight * factor;
+         total += s_sharedWeight;
+         --count;
+      }
+      return total + weight * count;
+   }
+   float StackWeightExpected(float weight, uint32_t count, bool worn, float factor) {
+      float total = 0.0F;
+      if (worn && count) {
+         float copy = weight;
+         copy = copy * factor;
+         total += copy;
+         --count;
+      }
+      return total + weight * count;
+   }
+
+   void worker(uint32_t index, const Options& options, const float** slotOut) {
+      std::mt19937 rng(index * 7919 + 1);
+      std::uniform_real_distribution<float> weights(0.1F, 50.0F);
+      const float factor = 0.5F + index * 0.01F; // each thread gets a different perk, so crossed results show up
+      *slotOut = Math::WeightSlot::Begin(0.0F);
+      while (!s_go)
+         std::this_thread::yield();
+      uint32_t mismatches = 0;
+      for (uint32_t i = 0; i < options.iterations; ++i) {
+         float    weight = weights(rng);
+         uint32_t count  = rng() % 8;
+         bool     worn   = (rng() & 1) != 0;
+         float    result;
+         if (options.shared) {
+            result = StackWeightShared(weight, count, worn, factor);
+         } else {
+            result = Math::StackWeight(weight, count, worn, [factor](float* w) {
+               std::this_thread::yield(); // give other threads a chance to run between Begin and Read
+               *w = *w * factor;
+            });
+         }
+         if (result != StackWeightExpected(weight, count, worn, factor))
+            ++mismatches;
+      }
+      s_mismatches += mismatches;
+      s_stacks     += options.iterations;
+   }
+}
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+         options.threads = strtoul(argv[++i], nullptr, 0);
+      else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+         options.iterations = strtoul(argv[++i], nullptr, 0);
+      else if (!strcmp(argv[i], "--shared"))
+         options.shared = true;
+   }
+   if (!options.threads) {
+      options.threads = std::thread::hardware_concurrency() * 2;
+      if (options.threads < 8)
+         options.threads = 8;
+   }
+   std::vector<std::thread>  threads;
+   std::vector<const float*> slots(options.threads);
+   for (uint32_t i = 0; i < options.threads; ++i)
+      threads.emplace_back(worker, i, std::cref(options), &slots[i]);
+   auto start = std::chrono::steady_clock::now();
+   s_go = true;
+   for (auto& t : threads)
+      t.join();
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   //
+   std::set<const float*> distinct(slots.begin(), slots.end());
+   uint32_t mismatches = s_mismatches;
+   printf("%s copy: %u threads, %llu stacks in %.2f seconds; %u mismatches; %zu distinct weight slots.\n",
+      options.shared ? "Shared" : "Thread-local",
+      options.threads,
+      (unsigned long long)s_stacks.load(),
+      seconds,
+      mismatches,
+      distinct.size()
+   );
+   if (options.shared)
+      return 0; // mismatches are expected here
+   if (distinct.size() != options.threads) {
+      fprintf(stderr, "FAILED: threads shared a weight slot.\n");
+      return 1;
+   }
+   return mismatches ? 1 : 0;
+}
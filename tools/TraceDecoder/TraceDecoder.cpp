@@ -0,0 +1,190 @@
+//
+// Decoder for the binary trace files written by CobbBugFixes (see Services/Trace.h in the
+// plugin). This is a standalone program with no dependencies beyond the standard library;
+// build it with any C++17 compiler, e.g.:
+//
+//    g++ -std=c++17 -O2 -Wno-multichar -o trace-decoder TraceDecoder.cpp
+//
+// Usage:
+//
+//    trace-decoder [--csv] [--event NAME] CobbBugFixes.trace
+//
+// Text output prints one record per line. CSV output prints one row per record; if --event
+// is given, the column headers are that event's field names, and otherwise they're generic.
+//
+#include "../../plugin/CobbBugFixes/Services/TraceFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace CobbBugFixes::TraceFormat;
+
+namespace {
+   struct Options {
+      bool        csv = false;
+      const char* event = nullptr;
+      const char* path  = nullptr;
+   };
+
+   void print_usage() {
+      fprintf(stderr, "Usage: trace-decoder [--csv] [--event NAME] FILE\n");
+      fprintf(stderr, "Known events:\n");
+      for (auto& schema : g_events)
+         fprintf(stderr, "   %s\n", schema.name);
+   }
+
+   std::string format_field(const Record& r, uint32_t i, FieldType type) {
+      char buffer[ce_fieldCount * 4 + 1];
+      switch (type) {
+         case FieldType::u32:
+            snprintf(buffer, sizeof(buffer), "%u", r.data.u[i]);
+            break;
+         case FieldType::hex32:
+            snprintf(buffer, sizeof(buffer), "0x%08X", r.data.u[i]);
+            break;
+         case FieldType::form_id:
+            snprintf(buffer, sizeof(buffer), "%08X", r.data.u[i]);
+            break;
+         case FieldType::f32:
+            snprintf(buffer, sizeof(buffer), "%f", r.data.f[i]);
+            break;
+         case FieldType::str:
+            {
+               size_t max = (ce_fieldCount - i) * 4;
+               size_t len = strnlen(r.data.s + i * 4, max);
+               memcpy(buffer, r.data.s + i * 4, len);
+               buffer[len] = '\0';
+            }
+            break;
+         default:
+            buffer[0] = '\0';
+      }
+      return buffer;
+   }
+   std::string csv_escape(const std::string& s) {
+      if (s.find_first_of(",\"\n") == std::string::npos)
+         return s;
+      std::string out = "\"";
+      for (char c : s) {
+         if (c == '"')
+            out += '"';
+         out += c;
+      }
+      out += '"';
+      return out;
+   }
+}
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      if (!strcmp(argv[i], "--csv")) {
+         options.csv = true;
+      } else if (!strcmp(argv[i], "--event") && i + 1 < argc) {
+         options.event = argv[++i];
+      } else if (argv[i][0] == '-') {
+         print_usage();
+         return 1;
+      } else {
+         options.path = argv[i];
+      }
+   }
+   if (!options.path) {
+      print_usage();
+      return 1;
+   }
+   const EventSchema* filter = nullptr;
+   if (options.event) {
+      for (auto& schema : g_events)
+         if (!strcmp(schema.name, options.event))
+            filter = &schema;
+      if (!filter) {
+         fprintf(stderr, "Unknown event type: %s\n", options.event);
+         print_usage();
+         return 1;
+      }
+   }
+   //
+   FILE* file = fopen(options.path, "rb");
+   if (!file) {
+      fprintf(stderr, "Unable to open %s\n", options.path);
+      return 1;
+   }
+   FileHeader header;
+   if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != ce_magic) {
+      fprintf(stderr, "%s is not a CobbBugFixes trace file.\n", options.path);
+      fclose(file);
+      return 1;
+   }
+   if (header.version != ce_version || header.recordSize != sizeof(Record)) {
+      fprintf(stderr, "Unsupported trace version %u (record size %u).\n", header.version, header.recordSize);
+      fclose(file);
+      return 1;
+   }
+   std::vector<Record> records;
+   {
+      Record r;
+      for (uint32_t i = 0; i < header.capacity && fread(&r, sizeof(r), 1, file) == 1; ++i) {
+         if (!r.sequence) // never written, or torn by a crash
+            continue;
+         if (filter && r.event != (uint16_t)filter->id)
+            continue;
+         records.push_back(r);
+      }
+   }
+   fclose(file);
+   std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.sequence < b.sequence; });
+   //
+   double frequency = header.timerFrequency ? (double)header.timerFrequency : 1.0;
+   if (options.csv) {
+      printf("sequence,seconds,thread,event");
+      for (uint32_t i = 0; i < ce_fieldCount; ++i) {
+         if (filter) {
+            auto& field = filter->fields[i];
+            if (field.type == FieldType::none)
+               break;
+            printf(",%s", field.name);
+            if (field.type == FieldType::str)
+               break;
+         } else
+            printf(",field%u", i);
+      }
+      printf("\n");
+   }
+   for (auto& r : records) {
+      double seconds = (double)(int64_t)(r.timestamp - header.timerStart) / frequency;
+      auto   schema  = GetEventSchema(r.event);
+      std::string name = schema ? schema->name : ("Unknown" + std::to_string(r.event));
+      if (options.csv)
+         printf("%u,%.6f,%u,%s", r.sequence, seconds, r.thread, name.c_str());
+      else
+         printf("[%12.6fs] #%u T%05u %s", seconds, r.sequence, r.thread, name.c_str());
+      if (schema) {
+         for (uint32_t i = 0; i < ce_fieldCount; ++i) {
+            auto& field = schema->fields[i];
+            if (field.type == FieldType::none)
+               break;
+            auto value = format_field(r, i, field.type);
+            if (options.csv)
+               printf(",%s", csv_escape(value).c_str());
+            else
+               printf(" %s=%s", field.name, value.c_str());
+            if (field.type == FieldType::str)
+               break;
+         }
+      } else {
+         for (uint32_t i = 0; i < ce_fieldCount; ++i) {
+            if (options.csv)
+               printf(",0x%08X", r.data.u[i]);
+            else
+               printf(" 0x%08X", r.data.u[i]);
+         }
+      }
+      printf("\n");
+   }
+   if (!options.csv)
+      fprintf(stderr, "%zu records (%u claimed in total; ring capacity %u).\n", records.size(), header.cursor, header.capacity);
+   return 0;
+}